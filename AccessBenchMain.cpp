@@ -0,0 +1,259 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "AccessTree.hpp"
+#include "FenwickTree.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Benchmark of the item placement structures:
+// the plain FenwickTree per item (as SnakeWorld had it) against AccessTree.
+// Closes and opens random cells, walks a snake over the map (closing the head, opening the tail end)
+// and picks random positions like placing items.
+
+namespace {
+
+using namespace CrazySnakes;
+
+using fwt = FenwickTree<std::vector<std::uintmax_t>::iterator,
+    std::vector<std::uintmax_t>::const_iterator, std::ptrdiff_t, std::uintmax_t>;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t WalkTailSize = 256;
+
+struct Options {
+    std::size_t operationCount = 1000000;
+    std::uint64_t seed = 0;
+    std::vector<unsigned int> sides{ 64, 1024, 4096 };
+};
+
+struct Result {
+    double updateNs = 0;  // a cell closed and opened again
+    double walkNs = 0;    // a step of the snake: the head closed, the tail end opened
+    double findNs = 0;    // a random position of an item
+    std::uint64_t checksum = 0;
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: snatan-bench [options]\n"
+        "  -n <count>  operations of every kind (default: 1000000)\n"
+        "  -s <seed>   random seed (default: 0)\n"
+        "  -m <side>   one square map of the side only (default: 64, 1024 and 4096)\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strlen(argv[i]) != 2 || argv[i][0] != '-' || i + 1 >= argc)
+            return false;
+
+        const char* value = argv[++i];
+
+        switch (argv[i - 1][1]) {
+        case 'n':
+            options.operationCount = (std::size_t)std::strtoull(value, nullptr, 10);
+            break;
+        case 's':
+            options.seed = std::strtoull(value, nullptr, 10);
+            break;
+        case 'm':
+            options.sides.assign(1, (unsigned int)std::strtoul(value, nullptr, 10));
+            break;
+        default:
+            return false;
+        }
+    }
+    return options.operationCount != 0;
+}
+
+double getNs(Clock::duration duration, std::size_t count) {
+    return std::chrono::duration<double, std::nano>(duration).count() / (double)count;
+}
+
+// The plain trees over all the cells, one per item
+Result benchFenwick(Map<std::uint32_t> const* const* maps,
+                    const std::vector<sf::Vector2i>& cells,
+                    const std::vector<sf::Vector2i>& walk,
+                    const std::vector<std::uint64_t>& randoms) {
+    const sf::Vector2u& size = maps[0]->getSize();
+    std::size_t area = (std::size_t)size.x * size.y;
+    std::size_t treeSize = 2;
+    while (treeSize - 1 < area)
+        treeSize = (treeSize - 1) * 2 + 1;
+
+    std::vector<std::vector<std::uintmax_t>> trees(ItemCount);
+    for (int i = 0; i < ItemCount; ++i) {
+        trees[i].assign(treeSize, 0);
+        std::copy(maps[i]->data(), maps[i]->data() + area, trees[i].begin() + 1);
+        fwt::init(trees[i].begin(), trees[i].end());
+    }
+
+    auto setCell = [&](const sf::Vector2i& cell, bool open) {
+        std::ptrdiff_t index = cell.x + (std::ptrdiff_t)cell.y * size.x;
+        for (int i = 0; i < ItemCount; ++i) {
+            std::uintmax_t value = (open ? maps[i]->at(cell) : 0);
+            fwt::update(trees[i].begin(), trees[i].end(), index + 1,
+                        value - fwt::get(trees[i].begin(), index));
+        }
+    };
+
+    Result result;
+
+    Clock::time_point start = Clock::now();
+    for (const auto& cell : cells)
+        setCell(cell, false);
+    for (const auto& cell : cells)
+        setCell(cell, true);
+    result.updateNs = getNs(Clock::now() - start, cells.size());
+
+    start = Clock::now();
+    for (std::size_t i = 0; i < walk.size(); ++i) {
+        setCell(walk[i], false);
+        if (i >= WalkTailSize)
+            setCell(walk[i - WalkTailSize], true);
+    }
+    result.walkNs = getNs(Clock::now() - start, walk.size());
+
+    start = Clock::now();
+    for (std::size_t i = 0; i < randoms.size(); ++i) {
+        const auto& tree = trees[i % ItemCount];
+        std::uintmax_t sum = fwt::getSum(tree.begin(), tree.size() - 1);
+        std::size_t index = fwt::rankQuery(tree.begin(), tree.end(), randoms[i] % sum);
+        result.checksum = result.checksum * 31 + index;
+    }
+    result.findNs = getNs(Clock::now() - start, randoms.size());
+
+    return result;
+}
+
+
+Result benchAccessTree(Map<std::uint32_t> const* const* maps,
+                       const std::vector<sf::Vector2i>& cells,
+                       const std::vector<sf::Vector2i>& walk,
+                       const std::vector<std::uint64_t>& randoms) {
+    const sf::Vector2u& size = maps[0]->getSize();
+
+    AccessTree tree;
+    tree.reset(maps);
+
+    Result result;
+
+    Clock::time_point start = Clock::now();
+    for (const auto& cell : cells)
+        tree.close(cell.x, cell.y);
+    for (const auto& cell : cells)
+        tree.open(cell.x, cell.y);
+    result.updateNs = getNs(Clock::now() - start, cells.size());
+
+    start = Clock::now();
+    for (std::size_t i = 0; i < walk.size(); ++i) {
+        tree.close(walk[i].x, walk[i].y);
+        if (i >= WalkTailSize)
+            tree.open(walk[i - WalkTailSize].x, walk[i - WalkTailSize].y);
+    }
+    result.walkNs = getNs(Clock::now() - start, walk.size());
+
+    start = Clock::now();
+    for (std::size_t i = 0; i < randoms.size(); ++i) {
+        std::size_t channel = i % ItemCount;
+        sf::Vector2i cell = tree.find(channel, randoms[i] % tree.getSum(channel));
+        result.checksum = result.checksum * 31 + (cell.x + (std::size_t)cell.y * size.x);
+    }
+    result.findNs = getNs(Clock::now() - start, randoms.size());
+
+    return result;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937_64 generator(options.seed);
+
+    for (unsigned int side : options.sides) {
+        sf::Vector2u size(side, side);
+
+        // a quarter of the cells never get items
+        std::vector<Map<std::uint32_t>> maps(ItemCount);
+        std::vector<std::uint32_t> values((std::size_t)side * side);
+        for (auto& map : maps) {
+            for (auto& value : values)
+                value = (generator() % 4 ? (std::uint32_t)(generator() % 1000) + 1 : 0);
+            map.create(size, values.data());
+        }
+
+        Map<std::uint32_t> const* mapPtrs[ItemCount];
+        for (int i = 0; i < ItemCount; ++i)
+            mapPtrs[i] = &maps[i];
+
+        std::vector<sf::Vector2i> cells(options.operationCount);
+        for (auto& cell : cells)
+            cell = sf::Vector2i(int(generator() % side), int(generator() % side));
+
+        // the snake turns now and then and crosses the tile borders back and forth
+        std::vector<sf::Vector2i> walk(options.operationCount);
+        sf::Vector2i head(int(side / 2), int(side / 2));
+        int direction = 0;
+        for (auto& cell : walk) {
+            if (generator() % 8 == 0)
+                direction = int(generator() % 4);
+            head.x = int((head.x + side + (direction == 0) - (direction == 1)) % side);
+            head.y = int((head.y + side + (direction == 2) - (direction == 3)) % side);
+            cell = head;
+        }
+
+        std::vector<std::uint64_t> randoms(options.operationCount);
+        for (auto& random : randoms)
+            random = generator();
+
+        Result fenwick = benchFenwick(mapPtrs, cells, walk, randoms);
+        Result access = benchAccessTree(mapPtrs, cells, walk, randoms);
+
+        // the tiles are looked through in another order
+        bool paged = (std::size_t)side * side >= TriggerMapSize;
+
+        std::cout << side << 'x' << side << (paged ? " (paged)" : "") << '\n'
+            << "  FenwickTree: update " << fenwick.updateNs << " ns, walk " << fenwick.walkNs
+            << " ns, find " << fenwick.findNs << " ns\n"
+            << "  AccessTree:  update " << access.updateNs << " ns, walk " << access.walkNs
+            << " ns, find " << access.findNs << " ns\n";
+
+        if (!paged)
+            std::cout << "  same picks: " << (fenwick.checksum == access.checksum ? "yes" : "no") << '\n';
+    }
+
+    return EXIT_SUCCESS;
+}
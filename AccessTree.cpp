@@ -0,0 +1,519 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "AccessTree.hpp"
+#include "FenwickTree.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+using fwt = CrazySnakes::FenwickTree<std::vector<std::uintmax_t>::iterator,
+    std::vector<std::uintmax_t>::const_iterator, std::ptrdiff_t, std::uintmax_t>;
+
+// the greatest power of 2 not greater than val or 0
+std::size_t floorPow2(std::size_t val) noexcept {
+    std::size_t pow2 = val ? 1 : 0;
+    while (pow2 && pow2 <= val / 2)
+        pow2 *= 2;
+    return pow2;
+}
+
+// The position of the value-th unit in the sequence or count if it's beyond (then the value is
+// reduced by the sum of all). The groups are summed up first, it's vectorized well.
+std::size_t findInSequence(const std::uint32_t* values, std::size_t count, std::uintmax_t& value) noexcept {
+    constexpr std::size_t GroupSize = 16;
+
+    std::size_t i = 0;
+    for (; i + GroupSize <= count; i += GroupSize) {
+        std::uintmax_t sum = 0;
+        for (std::size_t j = 0; j < GroupSize; ++j)
+            sum += values[i + j];
+
+        if (value < sum)
+            break;
+        value -= sum;
+    }
+
+    for (; i < count; ++i) {
+        if (value < values[i])
+            return i;
+        value -= values[i];
+    }
+
+    return count;
+}
+
+// findInSequence for all the ascending values at once, they are beyond the offset
+void findSortedInSequence(const std::uint32_t* values, std::size_t count, std::uintmax_t offset,
+                          const std::uintmax_t* sorted, std::size_t sortedCount,
+                          std::size_t* positions) noexcept {
+    std::size_t i = 0;
+    std::uintmax_t end = offset + (count ? values[0] : 0);
+
+    for (std::size_t j = 0; j < sortedCount; ++j) {
+        while (sorted[j] >= end) {
+            assert(i + 1 < count);
+            end += values[++i];
+        }
+        positions[j] = i;
+    }
+}
+
+}
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::reset(Map<std::uint32_t> const* const* initial) {
+    const sf::Vector2u& mapSize = initial[0]->getSize();
+
+    for (std::size_t i = 0; i < ChannelCount; ++i) {
+        assert(initial[i]->getSize() == mapSize);
+        m_initial[i] = initial[i];
+        m_values[i].reset(mapSize, initial[i]->data());
+    }
+
+    m_undoLog.clear();
+    build();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::restore() {
+    m_undoLog.clear();
+
+    if (m_values.front().isMostlyChanged()) {
+        for (auto& values : m_values)
+            values.restore();
+
+        build();
+        return;
+    }
+
+    // the changed cells are opened one by one, then the values have nothing to restore
+    m_changedCells.clear();
+    for (const auto& values : m_values)
+        values.forEachChanged([this](int x, int y) { m_changedCells.emplace_back(x, y); });
+
+    bool logged = m_undoLogged;
+    m_undoLogged = false;
+
+    for (const auto& cell : m_changedCells)
+        open(cell.x, cell.y);
+
+    m_undoLogged = logged;
+
+    for (auto& values : m_values)
+        values.restore();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::setUndoLogged(bool logged) {
+    m_undoLogged = logged;
+    if (!logged)
+        std::vector<UndoEntry>().swap(m_undoLog);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::undo(std::size_t mark) {
+    assert(mark <= m_undoLog.size());
+
+    bool logged = m_undoLogged;
+    m_undoLogged = false;
+
+    while (m_undoLog.size() > mark) {
+        const UndoEntry& entry = m_undoLog.back();
+        set(entry.x, entry.y, entry.values);
+        m_undoLog.pop_back();
+    }
+
+    m_undoLogged = logged;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::build() {
+    const PagedGrid<std::uint32_t>& grid = m_values.front();
+    const sf::Vector2u& mapSize = grid.getSize();
+    std::size_t area = (std::size_t)mapSize.x * mapSize.y;
+    std::size_t valueCount = (grid.isPaged() ?
+                              ((std::size_t)grid.getTileCount().x * grid.getTileCount().y) << grid.TileShift :
+                              (area + BlockSize - 1) >> BlockShift);
+
+    // the whole tree is built wide and then split
+    std::vector<Node> nodes(valueCount + 1, Node{});
+    m_maxValue = 0;
+
+    for (std::size_t i = 0; i < ChannelCount; ++i) {
+        const std::uint32_t* initial = m_initial[i]->data();
+        m_maxValue = std::max(m_maxValue, *std::max_element(initial, initial + area));
+
+        // block sums
+        if (!grid.isPaged()) {
+            for (std::size_t j = 0; j < area; ++j)
+                nodes[(j >> BlockShift) + 1][i] += initial[j];
+            continue;
+        }
+
+        // tile row sums
+        for (unsigned int y = 0; y < mapSize.y; ++y) {
+            const std::uint32_t* row = initial + (std::size_t)y * mapSize.x;
+
+            for (unsigned int x = 0; x < mapSize.x; ++x)
+                nodes[getTreeIndex(x, y) + 1][i] += row[x];
+        }
+    }
+
+    std::ptrdiff_t size = (std::ptrdiff_t)nodes.size();
+    for (std::ptrdiff_t i = 1; i < size; ++i) {
+        std::ptrdiff_t j = fwt::getNext(i);
+        if (j < size) {
+            for (std::size_t k = 0; k < ChannelCount; ++k)
+                nodes[j][k] += nodes[i][k];
+        }
+    }
+
+    // the widths
+    m_blockCount = valueCount;
+    std::uintmax_t maxBlockSum = (std::uintmax_t)m_maxValue << BlockShift;
+    m_lowSpan = (maxBlockSum ? floorPow2((std::size_t)std::min<std::uintmax_t>(
+        UINT32_MAX / maxBlockSum, valueCount)) : floorPow2(valueCount));
+
+    m_highShift = 0;
+    while (m_lowSpan && ((std::size_t)1 << m_highShift) <= m_lowSpan)
+        ++m_highShift;
+
+    m_lowNodes.assign(m_lowSpan ? nodes.size() : 0, LowNode{});
+    m_highNodes.assign((valueCount >> m_highShift) + 1, Node{});
+    m_sums = Node{};
+
+    for (std::size_t i = 1; i < nodes.size(); ++i) {
+        for (std::size_t k = 0; k < ChannelCount; ++k) {
+            if ((i & (0 - i)) <= m_lowSpan)
+                m_lowNodes[i][k] = (std::uint32_t)nodes[i][k];
+            else
+                m_highNodes[i >> m_highShift][k] = nodes[i][k];
+        }
+    }
+
+    for (std::size_t i = 0; i < ChannelCount; ++i) {
+        for (std::ptrdiff_t j = size - 1; j != 0; j = fwt::getParent(j))
+            m_sums[i] += nodes[j][i];
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::set(std::size_t channel, int x, int y, std::uint32_t value) {
+    Values values;
+    for (std::size_t i = 0; i < ChannelCount; ++i)
+        values[i] = m_values[i].get(x, y);
+
+    values[channel] = value;
+    set(x, y, values);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::set(int x, int y, const Values& values) {
+    Node deltas;
+    Values previousValues;
+    bool changed = false;
+
+    for (std::size_t i = 0; i < ChannelCount; ++i) {
+        std::uint32_t previous = m_values[i].get(x, y);
+        previousValues[i] = previous;
+        if (previous == values[i]) {
+            deltas[i] = 0;
+            continue;
+        }
+
+        assert(values[i] <= m_maxValue);
+        deltas[i] = (std::uintmax_t)values[i] - previous; // not bug, but feature
+        m_values[i].set(x, y, values[i]);
+        changed = true;
+    }
+
+    if (!changed)
+        return;
+
+    if (m_undoLogged)
+        m_undoLog.push_back(UndoEntry{ x, y, previousValues });
+
+    update(getTreeIndex(x, y) + 1, deltas);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::close(const sf::Vector2i* cells, std::size_t count) {
+    m_closeDeltas.clear();
+
+    for (std::size_t i = 0; i < count; ++i) {
+        int x = cells[i].x;
+        int y = cells[i].y;
+
+        Node deltas;
+        Values previousValues;
+        bool changed = false;
+
+        for (std::size_t k = 0; k < ChannelCount; ++k) {
+            std::uint32_t previous = m_values[k].get(x, y);
+            previousValues[k] = previous;
+            deltas[k] = 0 - (std::uintmax_t)previous;
+            if (previous) {
+                m_values[k].set(x, y, 0);
+                changed = true;
+            }
+        }
+
+        if (!changed)
+            continue;
+
+        if (m_undoLogged)
+            m_undoLog.push_back(UndoEntry{ x, y, previousValues });
+
+        m_closeDeltas.emplace_back(getTreeIndex(x, y) + 1, deltas);
+    }
+
+    std::sort(m_closeDeltas.begin(), m_closeDeltas.end(),
+              [](const auto& left, const auto& right) { return left.first < right.first; });
+
+    // merged by the blocks
+    std::size_t blockCount = 0;
+    for (std::size_t i = 0; i < m_closeDeltas.size(); ++i) {
+        if (blockCount && m_closeDeltas[blockCount - 1].first == m_closeDeltas[i].first) {
+            for (std::size_t k = 0; k < ChannelCount; ++k)
+                m_closeDeltas[blockCount - 1].second[k] += m_closeDeltas[i].second[k];
+        } else {
+            m_closeDeltas[blockCount++] = m_closeDeltas[i];
+        }
+    }
+    m_closeDeltas.resize(blockCount);
+
+    // past so many blocks one pass over the whole tree is cheaper than a walk per block
+    constexpr std::size_t DenseBlockRatio = 8;
+
+    if (blockCount * DenseBlockRatio < m_blockCount) {
+        for (const auto& delta : m_closeDeltas)
+            update(delta.first, delta.second);
+        return;
+    }
+
+    // the deltas become a tree of their own, summed into this one node by node
+    std::ptrdiff_t size = (std::ptrdiff_t)m_blockCount + 1;
+    m_denseDeltas.assign((std::size_t)size, Node{});
+
+    for (const auto& delta : m_closeDeltas) {
+        m_denseDeltas[delta.first] = delta.second;
+        for (std::size_t k = 0; k < ChannelCount; ++k)
+            m_sums[k] += delta.second[k];
+    }
+
+    for (std::ptrdiff_t i = 1; i < size; ++i) {
+        std::ptrdiff_t j = fwt::getNext(i);
+        if (j < size) {
+            for (std::size_t k = 0; k < ChannelCount; ++k)
+                m_denseDeltas[j][k] += m_denseDeltas[i][k];
+        }
+
+        for (std::size_t k = 0; k < ChannelCount; ++k) {
+            if ((std::size_t)(i & -i) <= m_lowSpan)
+                m_lowNodes[i][k] += (std::uint32_t)m_denseDeltas[i][k];
+            else
+                m_highNodes[i >> m_highShift][k] += m_denseDeltas[i][k];
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::open(int x, int y) {
+    Values values;
+    for (std::size_t i = 0; i < ChannelCount; ++i)
+        values[i] = m_values[i].getInitial(x, y);
+
+    set(x, y, values);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::update(std::size_t index, const Node& deltas) noexcept {
+    std::ptrdiff_t size = (std::ptrdiff_t)m_blockCount + 1;
+    std::ptrdiff_t i = (std::ptrdiff_t)index;
+
+    // the low nodes wrap around like the wide ones, the sums fit
+    for (; i < size && (std::size_t)(i & -i) <= m_lowSpan; i = fwt::getNext(i)) {
+        for (std::size_t k = 0; k < ChannelCount; ++k)
+            m_lowNodes[i][k] += (std::uint32_t)deltas[k];
+    }
+
+    for (; i < size; i = fwt::getNext(i)) {
+        for (std::size_t k = 0; k < ChannelCount; ++k)
+            m_highNodes[i >> m_highShift][k] += deltas[k];
+    }
+
+    for (std::size_t k = 0; k < ChannelCount; ++k)
+        m_sums[k] += deltas[k];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t AccessTree::getTreeIndex(int x, int y) const noexcept {
+    const PagedGrid<std::uint32_t>& grid = m_values.front();
+
+    if (grid.isPaged())
+        return (grid.getTileIndex(x, y) << grid.TileShift) + (y & (grid.TileSide - 1));
+
+    return (x + (std::size_t)y * grid.getSize().x) >> BlockShift;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::uintmax_t AccessTree::getSum(std::size_t channel) const noexcept {
+    return m_sums[channel];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+sf::Vector2i AccessTree::find(std::size_t channel, std::uintmax_t value) const noexcept {
+    assert(value < getSum(channel));
+
+    // rank query, the value becomes the remainder
+    std::size_t index = 0;
+
+    for (std::size_t step = floorPow2(m_blockCount); step > 0; step >>= 1) {
+        if (index + step <= m_blockCount) {
+            std::uintmax_t node = getNode(index + step, channel);
+            if (node <= value) {
+                value -= node;
+                index += step;
+            }
+        }
+    }
+
+    // look through the block
+    std::size_t count;
+    const std::uint32_t* block = getBlock(channel, index, count);
+    std::size_t position = findInSequence(block, count, value);
+    assert(position < count);
+
+    return getBlockCell(index, position);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::findSorted(std::size_t channel, const std::uintmax_t* values, std::size_t count,
+                            sf::Vector2i* cells) const noexcept {
+    assert(std::is_sorted(values, values + count));
+    assert(!count || values[count - 1] < getSum(channel));
+
+    if (count)
+        findSorted(channel, 0, floorPow2(m_blockCount), 0, values, count, cells);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AccessTree::findSorted(std::size_t channel, std::size_t index, std::size_t step, std::uintmax_t offset,
+                            const std::uintmax_t* values, std::size_t count,
+                            sf::Vector2i* cells) const noexcept {
+    // the rank query of find, the lesser values go on apart where they turn off
+    for (; step > 0; step >>= 1) {
+        if (index + step > m_blockCount)
+            continue;
+
+        std::uintmax_t bound = offset + getNode(index + step, channel);
+        std::size_t lesser = std::size_t(std::lower_bound(values, values + count, bound) - values);
+        if (lesser == count)
+            continue;
+
+        if (lesser)
+            findSorted(channel, index, step >> 1, offset, values, lesser, cells);
+
+        values += lesser;
+        cells += lesser;
+        count -= lesser;
+        offset = bound;
+        index += step;
+    }
+
+    // look through the block once
+    std::size_t blockCount;
+    const std::uint32_t* block = getBlock(channel, index, blockCount);
+
+    std::size_t positions[BlockSize];
+    for (std::size_t i = 0; i < count; i += BlockSize) {
+        std::size_t groupCount = std::min(BlockSize, count - i);
+        findSortedInSequence(block, blockCount, offset, values + i, groupCount, positions);
+
+        for (std::size_t j = 0; j < groupCount; ++j)
+            cells[i + j] = getBlockCell(index, positions[j]);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+const std::uint32_t* AccessTree::getBlock(std::size_t channel, std::size_t index,
+                                          std::size_t& count) const noexcept {
+    const PagedGrid<std::uint32_t>& grid = m_values[channel];
+    const sf::Vector2u& mapSize = grid.getSize();
+
+    if (!grid.isPaged()) {
+        std::size_t first = index << BlockShift;
+        count = std::min(BlockSize, (std::size_t)mapSize.x * mapSize.y - first);
+        return grid.getCells() + first;
+    }
+
+    std::size_t tileIndex = index >> grid.TileShift;
+    const sf::Vector2u& tileCount = grid.getTileCount();
+    int left = int(tileIndex % tileCount.x) << grid.TileShift;
+    int y = (int(tileIndex / tileCount.x) << grid.TileShift) + int(index & (grid.TileSide - 1));
+    count = (std::size_t)(std::min(left + grid.TileSide, (int)mapSize.x) - left);
+
+    const std::uint32_t* tile = grid.getTile(tileIndex);
+    return (tile ? tile + grid.getTileOffset(0, y) :
+            m_initial[channel]->data() + left + (std::size_t)y * mapSize.x);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+sf::Vector2i AccessTree::getBlockCell(std::size_t index, std::size_t position) const noexcept {
+    const PagedGrid<std::uint32_t>& grid = m_values.front();
+    const sf::Vector2u& mapSize = grid.getSize();
+
+    if (!grid.isPaged()) {
+        std::size_t cell = (index << BlockShift) + position;
+        return sf::Vector2i(int(cell % mapSize.x), int(cell / mapSize.x));
+    }
+
+    std::size_t tileIndex = index >> grid.TileShift;
+    int left = int(tileIndex % grid.getTileCount().x) << grid.TileShift;
+    int y = (int(tileIndex / grid.getTileCount().x) << grid.TileShift) + int(index & (grid.TileSide - 1));
+    return sf::Vector2i(left + (int)position, y);
+}
+
+} // namespace CrazySnakes
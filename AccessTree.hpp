@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef ACCESS_TREE_HPP
+#define ACCESS_TREE_HPP
+#include "PagedGrid.hpp"
+#include "Map.hpp"
+#include "EatableItem.hpp"
+#include <array>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+// Item acquire probabilities of the map cells, a channel per item,
+// with their prefix sums to choose a random cell in proportion.
+// The channels share one Fenwick tree with interleaved nodes, so
+// a cell is changed for all the items by one walk; the current cell values
+// are kept aside and never summed up from the tree.
+// The tree is over the sums of the blocks of BlockSize cells, so it's that times smaller
+// and the descent mostly stays in cache; the block is then looked through sequentially.
+// The blocks of a whole map go row-major, a paged map (see PagedGrid) has a block per tile row.
+// The nodes covering few enough blocks to never exceed 32 bits (judging by the greatest
+// initial value) are kept 32-bit and apart from the wider upper ones, the tree isn't
+// rounded up to a power of two.
+class AccessTree {
+public:
+
+    static constexpr std::size_t ChannelCount = ItemCount;
+
+    static constexpr unsigned int BlockShift = 6;
+    static constexpr std::size_t BlockSize = (std::size_t)1 << BlockShift;
+
+    static_assert(BlockShift == PagedGrid<std::uint32_t>::TileShift);
+
+    using Values = std::array<std::uint32_t, ChannelCount>;
+
+    // initial: ChannelCount maps of the same size, dependencies;
+    // no value is set greater than the greatest initial one
+    void reset(Map<std::uint32_t> const* const* initial);
+
+    // all the cells back to the initial probabilities, costs as much as the cells changed
+    void restore();
+
+    // While logged, every change keeps the previous values of the cell, off drops the log.
+    // Restoring or resetting drops the log too.
+    void setUndoLogged(bool logged);
+
+    std::size_t getUndoMark() const noexcept {
+        return m_undoLog.size();
+    }
+
+    // back to the values at the mark, costs as much as the cells changed since then
+    void undo(std::size_t mark);
+
+    void clearUndo() noexcept {
+        m_undoLog.clear();
+    }
+
+    std::uint32_t get(std::size_t channel, int x, int y) const noexcept {
+        return m_values[channel].get(x, y);
+    }
+
+    void set(std::size_t channel, int x, int y, std::uint32_t value);
+
+    // all the channels in one walk
+    void set(int x, int y, const Values& values);
+
+    void close(int x, int y) {
+        set(x, y, Values{});
+    }
+
+    // All the cells at once (repeats allowed): the changes are merged by the blocks,
+    // so the tree is walked once per block or, if there are many, once at all.
+    void close(const sf::Vector2i* cells, std::size_t count);
+
+    // the initial probabilities
+    void open(int x, int y);
+
+    std::uintmax_t getSum(std::size_t channel) const noexcept;
+
+    // The cell with the value-th unit of the channel sum (value < getSum(channel)).
+    // Only the cells with non-zero probabilities can be found.
+    sf::Vector2i find(std::size_t channel, std::uintmax_t value) const noexcept;
+
+    // find for all the ascending values at once, cells[i] for values[i]:
+    // the descents part only where the values do, and every block is looked through once
+    void findSorted(std::size_t channel, const std::uintmax_t* values, std::size_t count,
+                    sf::Vector2i* cells) const noexcept;
+
+private:
+
+    using Node = std::array<std::uintmax_t, ChannelCount>;
+    using LowNode = std::array<std::uint32_t, ChannelCount>;
+
+    struct UndoEntry {
+        int x;
+        int y;
+        Values values;
+    };
+
+    // Fenwick tree from the initial probabilities
+    void build();
+
+    void update(std::size_t index, const Node& deltas) noexcept;
+
+    // findSorted from the node index - 1 and the step on, the values are beyond the offset
+    void findSorted(std::size_t channel, std::size_t index, std::size_t step, std::uintmax_t offset,
+                    const std::uintmax_t* values, std::size_t count, sf::Vector2i* cells) const noexcept;
+
+    // the values of the channel in the block (the tile row if paged)
+    const std::uint32_t* getBlock(std::size_t channel, std::size_t index, std::size_t& count) const noexcept;
+    sf::Vector2i getBlockCell(std::size_t index, std::size_t position) const noexcept;
+
+    std::uintmax_t getNode(std::size_t index, std::size_t channel) const noexcept {
+        if ((index & (0 - index)) <= m_lowSpan)
+            return m_lowNodes[index][channel];
+        return m_highNodes[index >> m_highShift][channel];
+    }
+
+    std::size_t getTreeIndex(int x, int y) const noexcept;
+
+    // Fenwick tree: the blocks or the tile rows if paged
+    std::vector<LowNode> m_lowNodes; // by the node index
+    std::vector<Node> m_highNodes;   // by the node index >> m_highShift
+    Node m_sums{};
+    std::size_t m_blockCount = 0;
+    std::size_t m_lowSpan = 0;      // the most blocks of a 32-bit node, a power of 2 or 0
+    unsigned int m_highShift = 0;   // log2(m_lowSpan * 2) or 0
+    std::uint32_t m_maxValue = 0;
+    std::array<PagedGrid<std::uint32_t>, ChannelCount> m_values;
+    std::array<const Map<std::uint32_t>*, ChannelCount> m_initial{};
+    std::vector<sf::Vector2i> m_changedCells; // restore() only
+    std::vector<std::pair<std::size_t, Node>> m_closeDeltas; // close() of many only, by the node index
+    std::vector<Node> m_denseDeltas;                          // the same, when propagated at once
+    std::vector<UndoEntry> m_undoLog;         // previous values, in order
+    bool m_undoLogged = false;
+};
+
+} // namespace CrazySnakes
+
+#endif // !ACCESS_TREE_HPP
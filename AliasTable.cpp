@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#include "AliasTable.hpp"
+#include "Randomizer.hpp"
+#include <cassert>
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void AliasTable::build(const std::uint32_t* weights, std::size_t count) {
+    assert(count <= UINT32_MAX);
+
+    m_columns.clear();
+    m_total = 0;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (weights[i]) {
+            m_columns.push_back(Column{ weights[i], (std::uint32_t)i, (std::uint32_t)i });
+            m_total += weights[i];
+        }
+    }
+
+    // A column holds m_total units. Weighed by the column count, the weights sum up to
+    // all the columns: the heavy ones fill up the light ones (< 2^64 as 32-bit by 32-bit).
+    std::uintmax_t columnCount = m_columns.size();
+    std::vector<std::uint32_t> light;
+    std::vector<std::uint32_t> heavy;
+
+    for (std::size_t i = 0; i < m_columns.size(); ++i) {
+        m_columns[i].threshold *= columnCount;
+        (m_columns[i].threshold < m_total ? light : heavy).push_back((std::uint32_t)i);
+    }
+
+    while (!light.empty() && !heavy.empty()) {
+        Column& lightColumn = m_columns[light.back()];
+        Column& heavyColumn = m_columns[heavy.back()];
+        light.pop_back();
+
+        lightColumn.alias = heavyColumn.index;
+        heavyColumn.threshold -= m_total - lightColumn.threshold;
+
+        if (heavyColumn.threshold < m_total) {
+            light.push_back(heavy.back());
+            heavy.pop_back();
+        }
+    }
+
+    // full ones
+    for (std::uint32_t i : heavy)
+        m_columns[i].threshold = m_total;
+    for (std::uint32_t i : light)
+        m_columns[i].threshold = m_total;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t AliasTable::draw(Randomizer& randomizer) const noexcept {
+    assert(!empty());
+
+    const Column& column = m_columns[randomizer.get(0, m_columns.size() - 1)];
+    return (randomizer.get(0, m_total - 1) < column.threshold ? column.index : column.alias);
+}
+
+} // namespace CrazySnakes
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef ALIAS_TABLE_HPP
+#define ALIAS_TABLE_HPP
+#include <vector>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+class Randomizer;
+
+// Draws an index in proportion to the static weights in O(1) (Walker's alias method):
+// a column at random, then the column index or its alias by the threshold.
+// Only the indices of non-zero weights get columns, so sparse weights take little.
+// Exact, the thresholds are integer.
+class AliasTable {
+public:
+
+    // weights: count values, fewer than 2^32
+    void build(const std::uint32_t* weights, std::size_t count);
+
+    // all the weights are zero
+    bool empty() const noexcept {
+        return m_columns.empty();
+    }
+
+    // an index of a non-zero weight (not empty)
+    std::size_t draw(Randomizer& randomizer) const noexcept;
+
+private:
+
+    struct Column {
+        std::uintmax_t threshold; // the index under it, the alias from it on (out of m_total)
+        std::uint32_t index;
+        std::uint32_t alias;
+    };
+
+    std::vector<Column> m_columns;
+    std::uintmax_t m_total = 0; // the sum of the weights
+};
+
+} // namespace CrazySnakes
+
+#endif // !ALIAS_TABLE_HPP
@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "GameData.hpp"
+#include "LevelAnalyzer.hpp"
+#include "FilePaths.hpp"
+#include "Constants.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Level solvability checker: searches every chosen level for a way
+// to do its challenge within the time limit and prints the shortest one found.
+
+namespace {
+
+using namespace CrazySnakes;
+
+struct Options {
+    std::string dataPath = DATA_PATH;
+    unsigned int diffCount = 3;
+    unsigned int levelCount = 12;
+    unsigned int difficulty = 0;
+    unsigned int levelIndex = 0;
+    bool allDifficulties = true;
+    bool allLevels = true;
+    LevelAnalyzer::Options analyzer;
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: snatan-analyze [options]\n"
+        "  -f <path>   data file (default: Resources/data.bin)\n"
+        "  -D <count>  difficulty count in the data file (default: 3)\n"
+        "  -L <count>  level count in the data file (default: 12)\n"
+        "  -d <index>  difficulty to check (default: all)\n"
+        "  -l <index>  level to check (default: all)\n"
+        "  -t <count>  threads (default: 0, all the cores)\n"
+        "  -n <count>  worlds (randomizer seeds) per level (default: 4)\n"
+        "  -s <seed>   the first seed (default: 0)\n"
+        "  -w <count>  beam width (default: 256)\n"
+        "  -m <MiB>    memory for the states (default: 1024)\n"
+        "  -k <count>  step limit (default: 100000)\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strlen(argv[i]) != 2 || argv[i][0] != '-' || i + 1 >= argc)
+            return false;
+
+        const char* value = argv[++i];
+
+        switch (argv[i - 1][1]) {
+        case 'f':
+            options.dataPath = value;
+            break;
+        case 'D':
+            options.diffCount = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 'L':
+            options.levelCount = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 'd':
+            options.allDifficulties = !std::strcmp(value, "all");
+            options.difficulty = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 'l':
+            options.allLevels = !std::strcmp(value, "all");
+            options.levelIndex = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 't':
+            options.analyzer.threadCount = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 'n':
+            options.analyzer.worldCount = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 's':
+            options.analyzer.seed = std::strtoull(value, nullptr, 10);
+            break;
+        case 'w':
+            options.analyzer.beamWidth = (std::size_t)std::strtoull(value, nullptr, 10);
+            break;
+        case 'm':
+            options.analyzer.memoryLimit = (std::size_t)std::strtoull(value, nullptr, 10) << 20;
+            break;
+        case 'k':
+            options.analyzer.stepLimit = std::strtoull(value, nullptr, 10);
+            break;
+        default:
+            return false;
+        }
+    }
+    return options.analyzer.worldCount && options.analyzer.beamWidth;
+}
+
+const char* getChallengeName(ChallengeType challenge) noexcept {
+    switch (challenge) {
+    case ChallengeType::Fruits:
+        return "fruits";
+    case ChallengeType::Bonuses:
+        return "bonuses";
+    case ChallengeType::Powerups:
+        return "powerups";
+    default:
+        return "?";
+    }
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    if (options.diffCount < DiffCountMin || options.diffCount > DiffCountMax ||
+        options.levelCount < LevelCountMin || options.levelCount > LevelCountMax ||
+        (!options.allDifficulties && options.difficulty >= options.diffCount) ||
+        (!options.allLevels && options.levelIndex >= options.levelCount)) {
+        std::cerr << "Wrong difficulty or level\n";
+        return EXIT_FAILURE;
+    }
+
+    GameData gameData;
+    auto dataLog{ gameData.loadFromFile(options.dataPath, options.diffCount, options.levelCount) };
+    if (dataLog) {
+        std::cerr << *dataLog << '\n';
+        return EXIT_FAILURE;
+    }
+
+    LevelAnalyzer analyzer(gameData);
+    bool allSolved = true;
+
+    std::cout << "diff level  challenge  solved   steps  exhaustive      states   beam   time s\n";
+
+    for (unsigned int d = 0; d < options.diffCount; ++d) {
+        for (unsigned int l = 0; l < options.levelCount; ++l) {
+            if ((!options.allDifficulties && d != options.difficulty) ||
+                (!options.allLevels && l != options.levelIndex))
+                continue;
+
+            auto started = std::chrono::steady_clock::now();
+            LevelAnalyzer::Result result = analyzer.analyze(d, l, options.analyzer);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+            std::cout << std::setw(4) << d << std::setw(6) << l
+                << std::setw(5) << result.challengeCount << ' ' << std::left << std::setw(8)
+                << getChallengeName(result.challenge) << std::right
+                << std::setw(4) << result.solvedCount << '/' << std::left << std::setw(3)
+                << result.worldCount << std::right
+                << std::setw(8) << result.minStepCount
+                << std::setw(12) << (result.exhaustive ? "yes" : "no")
+                << std::setw(12) << result.stateCount
+                << std::setw(7) << result.beamWidth
+                << std::setw(9) << std::fixed << std::setprecision(2) << elapsed.count() << std::endl;
+
+            allSolved = allSolved && result.solvedCount == result.worldCount;
+        }
+    }
+
+    return allSolved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
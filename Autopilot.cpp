@@ -0,0 +1,385 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "Autopilot.hpp"
+#include "GameImpl.hpp"
+#include "ObjectBehaviour.hpp"
+#include "ObjParamEnumUtility.hpp"
+#include <algorithm>
+#include <cassert>
+#include <queue>
+#include <unordered_set>
+
+namespace {
+
+using namespace CrazySnakes;
+
+// states looked through to choose the way with no path
+constexpr std::size_t RoomLimit = 128;
+
+// more items are dense enough to be found breadth-first
+constexpr std::size_t DistanceTargetLimit = 64;
+
+// the most commands between the searches finding nothing, log2
+constexpr unsigned int MaxPlanDelayShift = 6;
+
+struct OpenEntry {
+    int cost;                 // the steps made and the distance left
+    std::uint32_t stepCount;
+    std::uint64_t key;
+
+    // the cheapest on the top
+    bool operator<(const OpenEntry& other) const noexcept {
+        return cost != other.cost ? cost > other.cost : stepCount < other.stepCount;
+    }
+};
+
+}
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void Autopilot::reset(const GameImpl& impl, ChallengeType challenge, std::size_t expansionLimit) {
+    assert(impl.getLevelPointers().objectTransitions);
+
+    m_impl = &impl;
+    m_challenge = challenge;
+    m_expansionLimit = expansionLimit;
+    m_mapSize = sf::Vector2i(impl.getSnakeWorld().getMapSize());
+    m_target = EatableItem::Count;
+    m_targets.clear();
+    m_plan.clear();
+    m_planIndex = 0;
+    m_failedPlanCount = 0;
+    m_nextPlanCommand = 0;
+    m_planReachesTarget = false;
+    m_statistics = Statistics();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Direction Autopilot::getCommand() {
+    assert(m_impl);
+    ++m_statistics.commandCount;
+
+    State current = getCurrentState();
+
+    EatableItem target = m_target;
+    chooseTarget();
+
+    bool targetThere = !m_planReachesTarget || m_plan.empty() ||
+        m_impl->getSnakeWorld().getItem(m_plan.back().state.position) == m_target;
+
+    // the path goes on
+    if (m_target == target && targetThere && m_planIndex < m_plan.size() && current == m_expected) {
+        const PlanStep& step = m_plan[m_planIndex];
+        State next;
+
+        if (advance(current, step.command, 0, next) && next == step.state) {
+            m_expected = next;
+            ++m_planIndex;
+            return step.command;
+        }
+    }
+
+    if (m_statistics.commandCount >= m_nextPlanCommand) {
+        plan(current);
+
+        if (!m_plan.empty()) {
+            m_failedPlanCount = 0;
+            m_expected = m_plan.front().state;
+            m_planIndex = 1;
+            return m_plan.front().command;
+        }
+
+        m_nextPlanCommand = m_statistics.commandCount +
+            ((std::uintmax_t)1 << std::min(m_failedPlanCount++, MaxPlanDelayShift));
+    }
+
+    // no path: the most room
+    ++m_statistics.fallbackCount;
+
+    Direction command = (current.direction == Direction::Count ? Direction::Up : current.direction);
+    std::size_t maxRoom = 0;
+
+    for (int d = 0; d < DirectionCount; ++d) {
+        State next;
+        if (!advance(current, (Direction)d, 0, next))
+            continue;
+
+        std::size_t room = getRoom(next);
+        if (room > maxRoom) {
+            maxRoom = room;
+            command = (Direction)d;
+        }
+    }
+
+    return command;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Autopilot::State Autopilot::getCurrentState() const noexcept {
+    const SnakeWorld& world = m_impl->getSnakeWorld();
+
+    State state;
+    state.position = world.getCurrentSnakePosition();
+    state.previousDirection = world.getPreviousDirection();
+    state.direction = m_impl->getSnakeDirection();
+    state.acceleration = m_impl->getSnakeAcceleration();
+    return state;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Autopilot::advance(const State& from, Direction command, std::uintmax_t depth, State& to) const {
+    // as GameImpl::pushCommand and GameImpl::move do
+    Direction direction = from.direction;
+    if (from.previousDirection == Direction::Count || command != oppositeDirection(from.previousDirection))
+        direction = command;
+
+    Acceleration acceleration = from.acceleration;
+
+    if (!applyObject(ObjectEffect::Pre, from.position, from.previousDirection, direction, acceleration))
+        return false;
+
+    // the snake wouldn't move at all
+    if (from.previousDirection != Direction::Count && direction == oppositeDirection(from.previousDirection))
+        return false;
+
+    to.position = from.position;
+    moveOnModulus(to.position, direction, m_mapSize);
+    to.previousDirection = direction;
+
+    if (!applyObject(ObjectEffect::Post, to.position, direction, direction, acceleration))
+        return false;
+
+    to.direction = direction;
+    to.acceleration = acceleration;
+
+    return !isTailAt(to.position, depth + 1);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Autopilot::applyObject(ObjectEffect effect, const sf::Vector2i& position, Direction previousDirection,
+                            Direction& direction, Acceleration& acceleration) const {
+    const GameImpl::LevelPointers& pointers = m_impl->getLevelPointers();
+    std::size_t index = position.x + (std::size_t)position.y * m_mapSize.x;
+
+    std::uint32_t pairIndex = pointers.objectPairIndices[index];
+    std::uint32_t behaviourIndex = (effect == ObjectEffect::Pre ? pointers.preEffectBehIndices :
+                                    pointers.postEffectBehIndices)[pairIndex];
+
+    ObjectTransitions::Outcome outcome;
+    ObjectTransitions::Lookup lookup = pointers.objectTransitions->find(
+        behaviourIndex, pointers.objectParams[index], m_impl->getObjectMemory(position.x, position.y),
+        previousDirection, direction, acceleration, outcome);
+
+    switch (lookup) {
+    case ObjectTransitions::Lookup::Known:
+        direction = outcome.snakeDirection;
+        acceleration = outcome.snakeAcceleration;
+        return !outcome.kills;
+    case ObjectTransitions::Lookup::Random:
+        // hoping it goes on, planned again if not
+        return !pointers.objectBehs[behaviourIndex].getProperty(ObjectProperty::IsDangerous);
+    default:
+        return false;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Autopilot::isTailAt(const sf::Vector2i& position, std::uintmax_t depth) const {
+    if (m_impl->getEffect() == EffectTypeAl::TailHarmless)
+        return false;
+
+    const SnakeWorld& world = m_impl->getSnakeWorld();
+    std::uintmax_t tailSize = world.getTailSize();
+    std::uintmax_t aimedTailSize = m_impl->getAimedTailSize();
+
+    // the back stays while the tail grows
+    std::uintmax_t growth = (aimedTailSize > tailSize ? aimedTailSize - tailSize : 0);
+    std::uintmax_t trimmed = (depth > growth ? depth - growth : 0);
+    std::uintmax_t oldest = std::max(world.getStepCount() + trimmed - tailSize,
+                                     m_impl->getHarmlessLessStepID());
+
+    std::size_t count = 0;
+    for (const auto& id : world.getTailIDs(position)) {
+        if (id.first >= oldest)
+            ++count;
+    }
+
+    const GameImpl::LevelPointers& pointers = m_impl->getLevelPointers();
+    std::size_t index = position.x + (std::size_t)position.y * m_mapSize.x;
+    return count > (std::size_t)pointers.tailCapacities1[pointers.objectPairIndices[index]] - 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void Autopilot::chooseTarget() {
+    const SnakeWorld& world = m_impl->getSnakeWorld();
+    m_targets.clear();
+
+    if (m_challenge == ChallengeType::Powerups && !world.getPowerups().empty()) {
+        m_target = EatableItem::Powerup;
+        if (world.getPowerups().size() <= DistanceTargetLimit) {
+            for (const auto& powerup : world.getPowerups())
+                m_targets.push_back(powerup.first);
+        }
+    } else if (m_challenge != ChallengeType::Fruits && !world.getBonusPositions().empty()) {
+        m_target = EatableItem::Bonus;
+        if (world.getBonusPositions().size() <= DistanceTargetLimit)
+            m_targets.assign(world.getBonusPositions().begin(), world.getBonusPositions().end());
+    } else if (!world.getFruitPositions().empty()) {
+        m_target = EatableItem::Fruit;
+        if (world.getFruitPositions().size() <= DistanceTargetLimit)
+            m_targets.assign(world.getFruitPositions().begin(), world.getFruitPositions().end());
+    } else {
+        m_target = EatableItem::Count;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+int Autopilot::getTargetDistance(const sf::Vector2i& position) const noexcept {
+    if (m_impl->getSnakeWorld().getItem(position) == m_target)
+        return 0;
+
+    // at least a step
+    if (m_targets.empty())
+        return 1;
+
+    int distance = m_mapSize.x + m_mapSize.y;
+
+    for (const auto& target : m_targets) {
+        int dx = std::abs(position.x - target.x);
+        int dy = std::abs(position.y - target.y);
+        distance = std::min(distance, std::min(dx, m_mapSize.x - dx) + std::min(dy, m_mapSize.y - dy));
+    }
+
+    return distance;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void Autopilot::plan(const State& start) {
+    ++m_statistics.planCount;
+    m_plan.clear();
+    m_planIndex = 0;
+    m_planReachesTarget = false;
+
+    if (m_target == EatableItem::Count)
+        return;
+
+    m_records.clear();
+
+    std::priority_queue<OpenEntry> open;
+    std::uint64_t startKey = getKey(start);
+    m_records.emplace(startKey, Record{ start, startKey, 0, Direction::Count });
+    open.push(OpenEntry{ getTargetDistance(start.position), 0, startKey });
+
+    // the target or the closest to it if not reached
+    std::uint64_t bestKey = startKey;
+    int bestDistance = getTargetDistance(start.position);
+    std::size_t expansionCount = 0;
+
+    while (!open.empty() && expansionCount < m_expansionLimit) {
+        OpenEntry entry = open.top();
+        open.pop();
+
+        // the records move on inserting
+        Record record = m_records.at(entry.key);
+        if (entry.stepCount != record.stepCount)
+            continue;
+
+        int distance = entry.cost - (int)entry.stepCount;
+        if (entry.key != startKey && (distance < bestDistance || !distance)) {
+            bestDistance = distance;
+            bestKey = entry.key;
+            if (!distance)
+                break;
+        }
+
+        ++expansionCount;
+
+        for (int d = 0; d < DirectionCount; ++d) {
+            State next;
+            if (!advance(record.state, (Direction)d, record.stepCount, next))
+                continue;
+
+            std::uint32_t stepCount = record.stepCount + 1;
+            std::uint64_t key = getKey(next);
+            auto inserted = m_records.try_emplace(key, Record{ next, entry.key, stepCount, (Direction)d });
+
+            if (!inserted.second) {
+                if (inserted.first->second.stepCount <= stepCount)
+                    continue;
+                inserted.first->second = Record{ next, entry.key, stepCount, (Direction)d };
+            }
+
+            open.push(OpenEntry{ (int)stepCount + getTargetDistance(next.position), stepCount, key });
+        }
+    }
+
+    m_statistics.expansionCount += expansionCount;
+    m_planReachesTarget = !bestDistance;
+
+    for (std::uint64_t key = bestKey; key != startKey;) {
+        const Record& record = m_records.at(key);
+        m_plan.push_back(PlanStep{ record.command, record.state });
+        key = record.parentKey;
+    }
+
+    std::reverse(m_plan.begin(), m_plan.end());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t Autopilot::getRoom(const State& state) const {
+    std::unordered_set<std::uint64_t> seen{ getKey(state) };
+    std::vector<std::pair<State, std::uintmax_t>> queue{ { state, 1 } };
+
+    for (std::size_t i = 0; i < queue.size() && seen.size() < RoomLimit; ++i) {
+        for (int d = 0; d < DirectionCount; ++d) {
+            State next;
+            if (advance(queue[i].first, (Direction)d, queue[i].second, next) && seen.insert(getKey(next)).second)
+                queue.emplace_back(next, queue[i].second + 1);
+        }
+    }
+
+    return seen.size();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::uint64_t Autopilot::getKey(const State& state) const noexcept {
+    std::uint64_t cell = state.position.x + (std::uint64_t)state.position.y * (std::uint64_t)m_mapSize.x;
+    return ((cell * (DirectionCount + 1) + (std::uint64_t)state.previousDirection) * (DirectionCount + 1) +
+            (std::uint64_t)state.direction) * AccelerationCount + (std::uint64_t)state.acceleration;
+}
+
+} // namespace CrazySnakes
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef AUTOPILOT_HPP
+#define AUTOPILOT_HPP
+#include "ObjectTransitions.hpp"
+#include "EatableItem.hpp"
+#include "MiscEnum.hpp"
+#include <SFML/System/Vector2.hpp>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+class GameImpl;
+enum class ObjectEffect;
+
+/// Plays the game on its own (the attract mode, the soak tests): gives the command
+/// to push after every step. The snake is predicted through the objects by
+/// the precomputed ObjectTransitions (the tubes, the rotors, the pointers, the accelerators,
+/// the stoppers etc.), no object program is run. A path to the nearest item leading to
+/// the challenge is found by A* over the cells, the directions and the accelerations,
+/// avoiding the tail as it will be at the step. The path is followed while the snake
+/// is where it was predicted, its item is still there and the next step is still safe,
+/// otherwise it's planned again. With no path the snake goes where it has the most room
+/// and the next searches are put off more and more (the item may be walled off).
+class Autopilot {
+public:
+
+    struct Statistics {
+        std::uintmax_t commandCount = 0;
+        std::uintmax_t planCount = 0;     // A* searches
+        std::uintmax_t expansionCount = 0;
+        std::uintmax_t fallbackCount = 0; // commands given with no path
+    };
+
+    static constexpr std::size_t DefaultExpansionLimit = (std::size_t)1 << 16;
+
+    // impl: the game to play, a dependency (its level pointers must have the object transitions);
+    // on every level load or restart
+    void reset(const GameImpl& impl, ChallengeType challenge,
+               std::size_t expansionLimit = DefaultExpansionLimit);
+
+    // the command to push right after a step (or before the first one)
+    Direction getCommand();
+
+    const Statistics& getStatistics() const noexcept {
+        return m_statistics;
+    }
+
+private:
+
+    // the snake right after a step
+    struct State {
+        sf::Vector2i position;
+        Direction previousDirection = Direction::Count;
+        Direction direction = Direction::Count;
+        Acceleration acceleration = Acceleration::Default;
+
+        bool operator==(const State& other) const noexcept {
+            return position == other.position && previousDirection == other.previousDirection &&
+                direction == other.direction && acceleration == other.acceleration;
+        }
+    };
+
+    struct PlanStep {
+        Direction command;
+        State state; // after the step
+    };
+
+    struct Record {
+        State state;
+        std::uint64_t parentKey;
+        std::uint32_t stepCount;
+        Direction command;
+    };
+
+    State getCurrentState() const noexcept;
+
+    // the state after the command, false if the snake dies or the outcome isn't known;
+    // depth: the steps made since now
+    bool advance(const State& from, Direction command, std::uintmax_t depth, State& to) const;
+
+    bool applyObject(ObjectEffect effect, const sf::Vector2i& position, Direction previousDirection,
+                     Direction& direction, Acceleration& acceleration) const;
+
+    bool isTailAt(const sf::Vector2i& position, std::uintmax_t depth) const;
+
+    // the item to go for; the positions for the distance if there are few of them
+    void chooseTarget();
+    int getTargetDistance(const sf::Vector2i& position) const noexcept;
+
+    // A* to the nearest target (the closest state found if too far)
+    void plan(const State& start);
+
+    // states reachable from the state, up to the limit
+    std::size_t getRoom(const State& state) const;
+
+    std::uint64_t getKey(const State& state) const noexcept;
+
+    const GameImpl* m_impl = nullptr;
+    ChallengeType m_challenge = ChallengeType::Fruits;
+    std::size_t m_expansionLimit = DefaultExpansionLimit;
+    sf::Vector2i m_mapSize;
+    EatableItem m_target = EatableItem::Count;
+    std::vector<sf::Vector2i> m_targets; // empty if too many, no distance then
+    std::vector<PlanStep> m_plan;
+    std::size_t m_planIndex = 0;
+    unsigned int m_failedPlanCount = 0; // in a row
+    std::uintmax_t m_nextPlanCommand = 0;
+    bool m_planReachesTarget = false;
+    State m_expected;
+    std::unordered_map<std::uint64_t, Record> m_records; // plan() only
+    Statistics m_statistics;
+};
+
+} // namespace CrazySnakes
+
+#endif // !AUTOPILOT_HPP
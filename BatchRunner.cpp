@@ -0,0 +1,284 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "BatchRunner.hpp"
+#include "GameData.hpp"
+#include "Game.hpp"
+#include "Randomizer.hpp"
+#include "AttribEnums.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace {
+
+using namespace CrazySnakes;
+
+// few games are taken at once, so the workers rarely meet at the counter
+constexpr unsigned int GameChunk = 8;
+
+// splitmix64, the games of near numbers get unrelated seeds
+std::uint64_t getGameSeed(std::uint64_t seed, std::uint64_t gameNumber) noexcept {
+    std::uint64_t z = seed + (gameNumber + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+
+// Plays the games of the job taken from nextGame one by one
+class Worker {
+public:
+
+    Worker(const LevelSetup& setup, const BatchRunner::Options& options, std::uint64_t firstGame) :
+        m_setup(&setup),
+        m_options(&options),
+        m_firstGame(firstGame) {
+        const GameData& data = *setup.getGameData();
+        const std::uint32_t* attribs = data.getLevels().getLevelAttribPtr(setup.getDifficulty(),
+                                                                          setup.getLevelIndex());
+        const std::uint32_t* plot = data.getLevels().getLevelPlotDataPtr(setup.getDifficulty(),
+                                                                         setup.getLevelIndex());
+
+        m_commandPeriod = (options.commandPeriod > 0 ? options.commandPeriod :
+                           (std::int64_t)attribs[(int)LevelAttribEnum::SnakePeriod]);
+        m_challenge = (ChallengeType)plot[(int)LevelPlotDataEnum::Challenge];
+        m_challengeCount = plot[(int)LevelPlotDataEnum::ChallengeCount];
+
+        m_report.difficulty = setup.getDifficulty();
+        m_report.levelIndex = setup.getLevelIndex();
+    }
+
+    void operator()(std::atomic<unsigned int>& nextGame, unsigned int gameCount) noexcept {
+        try {
+            std::array<Randomizer*, RandomTypeCount> randomizers = m_gameRandomizers.getPointers();
+            m_game.restart(m_setup->createGameImpl(randomizers.data()));
+
+            for (;;) {
+                unsigned int first = nextGame.fetch_add(GameChunk);
+                if (first >= gameCount)
+                    break;
+
+                unsigned int last = std::min(first + GameChunk, gameCount);
+                for (unsigned int i = first; i < last; ++i)
+                    playGame(m_firstGame + i);
+            }
+        } catch (...) {
+            m_exception = std::current_exception();
+        }
+    }
+
+    const BatchRunner::Report& getReport() const noexcept {
+        return m_report;
+    }
+
+    const std::exception_ptr& getException() const noexcept {
+        return m_exception;
+    }
+
+private:
+
+    void playGame(std::uint64_t gameNumber);
+
+    const LevelSetup* m_setup;
+    const BatchRunner::Options* m_options;
+    std::uint64_t m_firstGame;
+    std::int64_t m_commandPeriod = 0;
+    ChallengeType m_challenge = ChallengeType::Fruits;
+    std::uint32_t m_challengeCount = 0;
+    RandomizerSet m_gameRandomizers;
+    Randomizer m_inputRandomizer;
+    Game m_game;
+    std::array<Game::Event, 64> m_events{};
+    BatchRunner::Report m_report;
+    std::exception_ptr m_exception;
+};
+
+
+void Worker::playGame(std::uint64_t gameNumber) {
+    std::uint64_t seed = getGameSeed(m_options->seed, gameNumber);
+    m_gameRandomizers.setSeed(seed);
+    m_inputRandomizer.setSeed(seed, RandomizerSet::StreamCount);
+
+    m_game.restart(m_setup->getInitialObjectMemory());
+
+    static_assert((int)GameSubevent::BonusEaten - (int)GameSubevent::FruitEaten == (int)ChallengeType::Bonuses &&
+                  (int)GameSubevent::PowerupEaten - (int)GameSubevent::FruitEaten == (int)ChallengeType::Powerups);
+
+    auto challengeEvent = (GameSubevent)((int)GameSubevent::FruitEaten + (int)m_challenge);
+
+    std::int64_t now = 0;
+    std::uintmax_t steps = 0;
+    std::uint32_t eatenCount = 0;
+    bool completed = (eatenCount >= m_challengeCount);
+
+    while (!completed && m_game.getImpl().isSnakeAlive() && steps < m_options->stepLimit) {
+        now += m_commandPeriod;
+        m_game.pushCommand(now, (Direction)m_inputRandomizer.get(0, DirectionCount - 1));
+        m_game.update(now);
+
+        std::size_t count;
+        do {
+            count = m_game.pollEvents(m_events.data(), m_events.size());
+
+            for (std::size_t i = 0; i < count && !completed; ++i) {
+                const Game::Event& event = m_events[i];
+
+                if (event.isMain && event.mainGameEvent == MainGameEvent::Moved) {
+                    ++steps;
+                } else if (!event.isMain && event.subevent == challengeEvent) {
+                    completed = (++eatenCount >= m_challengeCount);
+                }
+            }
+        } while (count == m_events.size());
+    }
+
+    ++m_report.gameCount;
+    m_report.stepCount += steps;
+
+    if (completed) {
+        ++m_report.completedCount;
+        m_report.completionStepCount += steps;
+    } else {
+        ++m_report.deathCounts[(std::size_t)m_game.getImpl().getDeathCause()];
+    }
+}
+
+
+// Joins the started threads however the scope is left, so none is destroyed joinable
+class ThreadGuard {
+public:
+
+    explicit ThreadGuard(std::vector<std::thread>& threads) noexcept :
+        m_threads(&threads) {
+    }
+
+    ThreadGuard(const ThreadGuard&) = delete;
+    ThreadGuard& operator=(const ThreadGuard&) = delete;
+
+    ~ThreadGuard() {
+        join();
+    }
+
+    void join() {
+        for (auto& thread : *m_threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
+private:
+
+    std::vector<std::thread>* m_threads;
+};
+
+}
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+double BatchRunner::Report::getCompletionRate() const noexcept {
+    return gameCount ? (double)completedCount / (double)gameCount : 0;
+}
+
+
+double BatchRunner::Report::getAverageCompletionSteps() const noexcept {
+    return completedCount ? (double)completionStepCount / (double)completedCount : 0;
+}
+
+
+double BatchRunner::Report::getAverageSteps() const noexcept {
+    return gameCount ? (double)stepCount / (double)gameCount : 0;
+}
+
+
+void BatchRunner::Report::add(const Report& other) noexcept {
+    gameCount += other.gameCount;
+    completedCount += other.completedCount;
+    completionStepCount += other.completionStepCount;
+    stepCount += other.stepCount;
+
+    for (std::size_t i = 0; i < deathCounts.size(); ++i)
+        deathCounts[i] += other.deathCounts[i];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<BatchRunner::Report> BatchRunner::run(const std::vector<Job>& jobs, const Options& options) const {
+    unsigned int threadCount = options.threadCount;
+    if (!threadCount)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<Report> reports;
+    reports.reserve(jobs.size());
+
+    LevelSetup setup;
+    std::uint64_t firstGame = 0;
+
+    // the jobs go one after another, so only one level is expanded at once
+    for (const Job& job : jobs) {
+        setup.create(*m_data, job.difficulty, job.levelIndex);
+
+        std::atomic<unsigned int> nextGame{ 0 };
+        unsigned int workerCount = std::max(1u, std::min(threadCount, (job.gameCount + GameChunk - 1) / GameChunk));
+
+        std::vector<Worker> workers;
+        workers.reserve(workerCount);
+        for (unsigned int i = 0; i < workerCount; ++i)
+            workers.emplace_back(setup, options, firstGame);
+
+        // the calling thread is one of the workers
+        std::vector<std::thread> threads;
+        ThreadGuard threadGuard(threads);
+        threads.reserve(workerCount - 1);
+        for (unsigned int i = 1; i < workerCount; ++i)
+            threads.emplace_back(std::ref(workers[i]), std::ref(nextGame), job.gameCount);
+
+        workers.front()(nextGame, job.gameCount);
+
+        threadGuard.join();
+
+        Report report;
+        report.difficulty = job.difficulty;
+        report.levelIndex = job.levelIndex;
+
+        for (const Worker& worker : workers) {
+            if (worker.getException())
+                std::rethrow_exception(worker.getException());
+            report.add(worker.getReport());
+        }
+
+        reports.push_back(report);
+        firstGame += job.gameCount;
+
+        if (options.levelEnded)
+            options.levelEnded(reports.back());
+    }
+
+    return reports;
+}
+
+} // namespace CrazySnakes
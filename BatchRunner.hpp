@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+#include "MiscEnum.hpp"
+#include <array>
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+class GameData;
+
+/// Plays many independent games with random commands on all the cores
+/// and sums them up per level (to balance the levels).
+/// The game data and the expanded maps of the level are shared by the workers read-only,
+/// every worker has its own game and randomizers.
+/// A game is seeded by the batch seed and its number, so the reports don't depend on the thread count.
+class BatchRunner {
+public:
+
+    // games of one level
+    struct Job {
+        unsigned int difficulty = 0;
+        unsigned int levelIndex = 0;
+        unsigned int gameCount = 0;
+    };
+
+    // the games of one job
+    struct Report {
+        unsigned int difficulty = 0;
+        unsigned int levelIndex = 0;
+        std::uintmax_t gameCount = 0;
+        std::uintmax_t completedCount = 0;      // the challenge has been done
+        std::uintmax_t completionStepCount = 0; // steps to do the challenge, the completed games
+        std::uintmax_t stepCount = 0;           // all the steps
+        std::array<std::uintmax_t, DeathCauseCount> deathCounts{}; // the games not completed
+
+        double getCompletionRate() const noexcept;
+        double getAverageCompletionSteps() const noexcept;
+        double getAverageSteps() const noexcept;
+
+        void add(const Report& other) noexcept;
+    };
+
+    struct Options {
+        unsigned int threadCount = 0;        // 0 means all the cores
+        std::uint64_t seed = 0;
+        std::int64_t commandPeriod = 0;      // of the random commands, 0 means the snake period
+        std::uintmax_t stepLimit = 1000000;  // the game is given up then (NoDeath)
+        std::function<void(const Report&)> levelEnded; // if any, called by run as each job ends
+    };
+
+    // data: a dependency
+    explicit BatchRunner(const GameData& data) noexcept :
+        m_data(&data) {}
+
+    // a report per job, in order; the exceptions of the workers are thrown here
+    std::vector<Report> run(const std::vector<Job>& jobs, const Options& options) const;
+
+private:
+
+    const GameData* m_data;
+};
+
+} // namespace CrazySnakes
+
+#endif // !BATCH_RUNNER_HPP
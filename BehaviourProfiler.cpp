@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#include "BehaviourProfiler.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <tuple>
+
+namespace {
+
+using namespace CrazySnakes;
+
+using Clock = std::chrono::steady_clock;
+
+void merge(BehaviourProfiler::Table& destination, const BehaviourProfiler::Table& source) {
+    for (const auto& [key, from] : source) {
+        BehaviourProfiler::Counters& to = destination[key];
+
+        to.activations += from.activations;
+        to.runs += from.runs;
+        to.operations += from.operations;
+        to.nanoseconds += from.nanoseconds;
+        to.elseRuns += from.elseRuns;
+
+        if (to.firedConditions.size() < from.firedConditions.size())
+            to.firedConditions.resize(from.firedConditions.size());
+        for (std::size_t j = 0; j < from.firedConditions.size(); ++j)
+            to.firedConditions[j] += from.firedConditions[j];
+    }
+}
+
+// the counters of the ended threads
+struct Merged {
+    std::mutex mutex;
+    BehaviourProfiler::Table table;
+};
+
+Merged& getMerged() {
+    static Merged merged;
+    return merged;
+}
+
+// by the object pair * 2 + the effect
+constexpr std::size_t SlotCount = (std::size_t)ObjectPairCount * 2;
+
+struct ThreadCounters {
+    BehaviourProfiler::Table table;
+    BehaviourProfiler::Counters* current = nullptr; // of the effect
+    // the counters found last by the slot, to look the table up on a behaviour change only
+    std::array<BehaviourProfiler::Counters*, SlotCount> found{};
+    std::array<std::uint32_t, SlotCount> foundBehaviours{};
+    Clock::time_point started;
+    bool running = false;
+
+    ~ThreadCounters() {
+        Merged& merged = getMerged();
+        std::lock_guard<std::mutex> lock(merged.mutex);
+        merge(merged.table, table);
+    }
+};
+
+thread_local ThreadCounters threadCounters;
+
+}
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool BehaviourProfiler::Key::operator<(const Key& other) const noexcept {
+    return std::tie(objectPair, effect, behaviourIndex) <
+        std::tie(other.objectPair, other.effect, other.behaviourIndex);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void BehaviourProfiler::beginEffect(std::uint32_t objectPair, ObjectEffect effect,
+                                    std::uint32_t behaviourIndex) {
+    std::size_t slot = (std::size_t)objectPair * 2 + (std::size_t)effect;
+    Counters*& found = threadCounters.found[slot];
+
+    if (!found || threadCounters.foundBehaviours[slot] != behaviourIndex) {
+        found = &threadCounters.table[Key{ objectPair, effect, behaviourIndex }];
+        threadCounters.foundBehaviours[slot] = behaviourIndex;
+    }
+
+    ++found->activations;
+    threadCounters.current = found;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void BehaviourProfiler::beginRun() noexcept {
+    ++threadCounters.current->runs;
+    threadCounters.running = true;
+    threadCounters.started = Clock::now();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void BehaviourProfiler::countCommand(std::size_t commandIndex, std::size_t conditionCount,
+                                     std::size_t operationCount) {
+    // not run by an effect
+    if (!threadCounters.running)
+        return;
+
+    Counters& counters = *threadCounters.current;
+    counters.operations += operationCount;
+
+    if (commandIndex >= conditionCount) {
+        ++counters.elseRuns;
+        return;
+    }
+
+    if (counters.firedConditions.size() <= commandIndex)
+        counters.firedConditions.resize(commandIndex + 1);
+    ++counters.firedConditions[commandIndex];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void BehaviourProfiler::endRun() noexcept {
+    Clock::duration spent = Clock::now() - threadCounters.started;
+    threadCounters.current->nanoseconds +=
+        (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(spent).count();
+    threadCounters.running = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BehaviourProfiler::Table BehaviourProfiler::collect() {
+    Merged& merged = getMerged();
+    std::lock_guard<std::mutex> lock(merged.mutex);
+
+    Table table = merged.table;
+    merge(table, threadCounters.table);
+    return table;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void BehaviourProfiler::reset() {
+    Merged& merged = getMerged();
+    std::lock_guard<std::mutex> lock(merged.mutex);
+
+    merged.table.clear();
+    threadCounters.table.clear();
+    threadCounters.current = nullptr;
+    threadCounters.found.fill(nullptr);
+    threadCounters.running = false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void BehaviourProfiler::print(std::ostream& stream) {
+    Table table = collect();
+
+    std::vector<const Table::value_type*> order;
+    for (const auto& entry : table)
+        order.push_back(&entry);
+
+    std::stable_sort(order.begin(), order.end(), [](const Table::value_type* left, const Table::value_type* right) {
+        return left->second.nanoseconds > right->second.nanoseconds;
+    });
+
+    stream << "pair effect  beh  activations        runs  ops/run   ns/run    total ms  true conditions\n";
+
+    for (const Table::value_type* entry : order) {
+        const Key& key = entry->first;
+        const Counters& counters = entry->second;
+        double runs = (double)std::max<std::uint64_t>(counters.runs, 1);
+
+        stream << std::setw(4) << key.objectPair << std::setw(7) << (key.effect == ObjectEffect::Post ? "post" : "pre")
+            << std::setw(5) << key.behaviourIndex
+            << std::setw(13) << counters.activations << std::setw(12) << counters.runs
+            << std::fixed << std::setprecision(1)
+            << std::setw(9) << (double)counters.operations / runs
+            << std::setw(9) << (double)counters.nanoseconds / runs
+            << std::setprecision(3) << std::setw(12) << (double)counters.nanoseconds / 1e6 << ' ';
+
+        for (std::size_t j = 0; j < counters.firedConditions.size(); ++j) {
+            if (counters.firedConditions[j])
+                stream << ' ' << j << ':' << counters.firedConditions[j];
+        }
+
+        if (counters.elseRuns)
+            stream << " else:" << counters.elseRuns;
+
+        stream << '\n';
+    }
+
+    stream << std::defaultfloat << std::setprecision(6);
+}
+
+} // namespace CrazySnakes
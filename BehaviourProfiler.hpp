@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef BEHAVIOUR_PROFILER_HPP
+#define BEHAVIOUR_PROFILER_HPP
+#include "LevelElements.hpp"
+#include "ObjectEnums.hpp"
+#include <map>
+#include <vector>
+#include <iosfwd>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+/// Counters of the object effects (see GameImpl::objectEffect) by the object pair, the effect
+/// and the behaviour index (the levels give a pair other behaviours), to find the objects the steps spend the most on. Opt-in: built with SNATAN_PROFILE_BEHAVIOURS
+/// defined, otherwise Enabled is false and the hooks are never called nor compiled in.
+/// Every thread counts apart, its counters are merged as it ends.
+/// The quiet steps fast-forwarded by Game::update don't reach the effects, so they aren't counted.
+class BehaviourProfiler {
+public:
+
+#ifdef SNATAN_PROFILE_BEHAVIOURS
+    static constexpr bool Enabled = true;
+#else
+    static constexpr bool Enabled = false;
+#endif
+
+    struct Key {
+        std::uint32_t objectPair = 0;
+        ObjectEffect effect = ObjectEffect::Pre;
+        std::uint32_t behaviourIndex = 0;
+
+        bool operator<(const Key& other) const noexcept;
+    };
+
+    struct Counters {
+        std::uint64_t activations = 0;  // all the effects
+        std::uint64_t runs = 0;         // the programs run, not found in ObjectTransitions
+        std::uint64_t operations = 0;   // the instructions of the runs
+        std::uint64_t nanoseconds = 0;  // of the runs
+        std::uint64_t elseRuns = 0;     // no condition was true
+        std::vector<std::uint64_t> firedConditions; // the runs by the true condition index
+    };
+
+    using Table = std::map<Key, Counters>;
+
+    // The hooks (if Enabled only).
+    // An effect, then a run of its program (if any): countCommand is called by ObjectBehaviour::activate.
+    // The conditions are of the program run, a specialized one may have fewer.
+    static void beginEffect(std::uint32_t objectPair, ObjectEffect effect, std::uint32_t behaviourIndex);
+    static void beginRun() noexcept;
+    static void countCommand(std::size_t commandIndex, std::size_t conditionCount, std::size_t operationCount);
+    static void endRun() noexcept;
+
+    // the counters of the ended threads and the calling one
+    static Table collect();
+
+    static void reset();
+
+    // the collected counters, the costliest first
+    static void print(std::ostream& stream);
+};
+
+} // namespace CrazySnakes
+
+#endif // !BEHAVIOUR_PROFILER_HPP
@@ -26,7 +26,6 @@
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "BlockSnake.hpp"
-#include "FenwickTree.hpp"
 #include "TextureLoader.hpp"
 #include "Constants.hpp"
 #include "Endianness.hpp"
@@ -36,10 +35,10 @@
 #include "InterfaceEnums.hpp"
 #include "FileOutputStream.hpp"
 #include "ExternalConstants.hpp"
-#include "ObjectBehaviourLoader.hpp"
 #include "LanguageLoader.hpp"
 #include "LinguisticUtility.hpp"
 #include "ObjParamEnumUtility.hpp"
+#include "VisibleZone.hpp"
 #include <SFML/System/FileInputStream.hpp>
 #include <SFML/System/MemoryInputStream.hpp>
 #include <SFML/Graphics/Text.hpp>
@@ -103,29 +102,6 @@ sf::String getWord2fit(sf::String src,
     return src;
 }
 
-void fwkCreate(std::vector<std::uintmax_t>& vec, const std::uint32_t* values,
-               std::size_t sz) {
-    using fwt = CrazySnakes::FenwickTree<std::vector<std::uintmax_t>::iterator,
-        std::vector<std::uintmax_t>::const_iterator, std::ptrdiff_t, std::uintmax_t>;
-
-    constexpr auto realsize = [](std::size_t val) {
-        unsigned int bitlog = 0;
-        std::size_t tval = (val ? (val - 1) : 0);
-        while (tval) {
-            tval >>= 1;
-            ++bitlog;
-        }
-        return (std::size_t)1 + (val ? (((std::size_t)1u) << bitlog) : 0);
-    };
-
-    vec.resize(realsize(sz));
-
-    std::copy(values, values + sz, vec.data() + 1);
-    std::fill(vec.data() + sz + 1, vec.data() + vec.size(), 0);
-    vec[0] = 0;
-    fwt::init(vec.begin(), vec.end());
-}
-
 }
 
 namespace CrazySnakes {
@@ -1202,7 +1178,7 @@ StatisticMenu BlockSnake::statisticMenu(bool completed) {
 
     const auto lng = m_settings[(std::size_t)SettingEnum::LanguageIndex];
 
-    auto plotData = m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+    auto plotData = m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
 
     sf::String countableStr{
         getWord(lng, Word::LevelStatsLS) + ":\n" +
@@ -1600,72 +1576,21 @@ bool BlockSnake::loadData() {
         }
     }
 
-    sf::MemoryInputStream minp;
-    minp.open(dataInput.data(), dataInput.size() * 4);
-
     // COLORS
-    sf::Int64 ctntread = minp.read(m_colors.data(),
-                                      (sf::Int64)sizeof(std::uint32_t) * ColorDstCount);
-    if (ctntread != (sf::Int64)sizeof(std::uint32_t) * ColorDstCount)
-        return false;
-
-    // endianness
-    /*std::for_each(m_colors.begin(), m_colors.end(),
-                  [](std::uint32_t& v) {
-                      v = n2hl(v);
-                  });*/
-
-    // BEHAVIOR
-    auto objlog{ ObjectBehaviourLoader::loadFromStream(m_objectBehaviours, minp, false) };
-    if (objlog) {
-        m_logger << *objlog;
-        return false;
-    }
-
-    // BEHAVIOR MAP
-    ctntread = minp.read(m_objectPreEffects.data(),
-                         (sf::Int64)sizeof(std::uint32_t) * m_objectPreEffects.size());
-    if (ctntread != (sf::Int64)sizeof(std::uint32_t) *
-        (sf::Int64)m_objectPreEffects.size())
-        return false;
-
-    // endianness
-    /*std::for_each(m_objectPreEffects.begin(), m_objectPreEffects.end(),
-                  [](std::uint32_t& v) {
-                      v = n2hl(v);
-                  });*/
-
-    ctntread = minp.read(m_objectPostEffects.data(),
-                         (sf::Int64)sizeof(std::uint32_t) * m_objectPostEffects.size());
-
-    if (ctntread != (sf::Int64)sizeof(std::uint32_t) *
-        (sf::Int64)m_objectPostEffects.size())
+    if (dataInput.size() < (std::size_t)ColorDstCount)
         return false;
 
-    // endianness
-    /*std::for_each(m_objectPostEffects.begin(), m_objectPostEffects.end(),
-                  [](std::uint32_t& v) {
-                      v = n2hl(v);
-                  });*/
-
-    ctntread = minp.read(m_objectTailCapacities1.data(),
-                         (sf::Int64)sizeof(std::uint32_t) * m_objectTailCapacities1.size());
-    if (ctntread != (sf::Int64)sizeof(std::uint32_t) *
-        (sf::Int64)m_objectTailCapacities1.size())
-        return false;
-
-    // endianness
-    /*std::for_each(m_objectTailCapacities1.begin(), m_objectTailCapacities1.end(),
-                  [](std::uint32_t& v) {
-                      v = n2hl(v);
-                  });*/
+    std::copy(dataInput.begin(), dataInput.begin() + ColorDstCount, m_colors.begin());
 
     unsigned int diffCount = m_levelStatistics.getDifficultyCount();
     unsigned int levelCount = m_levelStatistics.getLevelCount();
 
-    // LEVELS
-    if (!m_levels.loadFromStream(diffCount, levelCount, minp, false))
+    // BEHAVIOR, BEHAVIOR MAP, LEVELS
+    auto datalog{ m_gameData.loadFromMemory(dataInput.data(), dataInput.size(), diffCount, levelCount) };
+    if (datalog) {
+        m_logger << *datalog << "\n";
         return false;
+    }
 
     return true;
 }
@@ -2428,7 +2353,7 @@ bool BlockSnake::playGame() {
     // check snake full view size
 
     const std::uint32_t* plotPtr =
-        m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+        m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
 
     sf::Vector2u snakeFullViewSize;
 
@@ -2441,7 +2366,7 @@ bool BlockSnake::playGame() {
     snakeScreenViewSize.x = plotPtr[(int)Lpde::SnakeSightX] * 2 + 3;
     snakeScreenViewSize.y = plotPtr[(int)Lpde::SnakeSightY] * 2 + 3;
 
-    const sf::Vector2u& mapSize = m_levels.getMapSize(m_difficulty, m_levelIndex);
+    const sf::Vector2u& mapSize = m_gameData.getLevels().getMapSize(m_difficulty, m_levelIndex);
 
     if (snakeFullViewSize.x > mapSize.x)
         return false;
@@ -2492,7 +2417,13 @@ bool BlockSnake::playGame() {
     {
         m_levelComplete = false;
 
-        m_game.restart(m_initialObjectMemory.data());
+        // the game has its own seed to be replayable alone
+        std::uint64_t runSeed = m_randomizer.get(0, UINT64_MAX);
+        m_gameRandomizers.setSeed(runSeed);
+        m_replay.start(m_difficulty, m_levelIndex, runSeed);
+
+        m_game.restart(m_levelSetup.getInitialObjectMemory());
+        resetAutopilot();
         playGameMusic();
 
         sf::Listener::setPosition((float)m_game.getImpl()
@@ -2556,10 +2487,16 @@ bool BlockSnake::playGame() {
 
             m_game.update(m_nowTime);
             processGameEvents();
+            updateAutopilot();
             scaleUpdate();
             drawWindow();
         }
 
+        m_replay.finish(m_nowTime);
+        auto replayLog{ m_replay.saveToFile(LAST_REPLAY_PATH) };
+        if (replayLog)
+            m_logger << *replayLog << std::endl;
+
         endGame();
 
     } while (m_gameAgain);
@@ -2590,8 +2527,8 @@ bool BlockSnake::playGame() {
 
 void BlockSnake::createChallVisual() {
   // Some links
-    const std::uint32_t* plotPtr = m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
-    const std::uint32_t* attribPtr = m_levels.getLevelAttribPtr(m_difficulty, m_levelIndex);
+    const std::uint32_t* plotPtr = m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+    const std::uint32_t* attribPtr = m_gameData.getLevels().getLevelAttribPtr(m_difficulty, m_levelIndex);
 
     auto dstintcol = [this](ColorDst dst) {return getDestinationIntColor(dst); };
     auto dstcol = [this](ColorDst dst) {return getDestinationColor(dst); };
@@ -2670,79 +2607,25 @@ void BlockSnake::createChallVisual() {
 
 
 void BlockSnake::prepareGame() {
-  // Some links
-
-    GameImpl::LevelPointers levelPtrs;
-    levelPtrs.attribArray = m_levels.getLevelAttribPtr(m_difficulty, m_levelIndex);
-    levelPtrs.effectDurations = m_levels.getEffectDurationPtr(m_difficulty, m_levelIndex);
-    levelPtrs.powerupProbs = &m_levels.getPowerupProbs(m_difficulty, m_levelIndex);
+    m_levelSetup.create(m_gameData, m_difficulty, m_levelIndex);
 
-    levelPtrs.objectBehs = m_objectBehaviours.data();
-    levelPtrs.postEffectBehIndices = m_objectPostEffects.data();
-    levelPtrs.preEffectBehIndices = m_objectPreEffects.data();
-    levelPtrs.tailCapacities1 = m_objectTailCapacities1.data();
-
-    const sf::Vector2u& mapSize = m_levels.getMapSize(m_difficulty, m_levelIndex);
+    const sf::Vector2u& mapSize = m_levelSetup.getMapSize();
     std::size_t area{ (std::size_t)mapSize.x * mapSize.y };
 
-    m_currentObjPairIndices.resize(area);
-    m_currentObjParams.resize(area);
     m_currentThemes.resize(area);
+    LevelSetup::expandCountMap(m_currentThemes.data(), area,
+                               m_gameData.getLevels().getLevelCountMap(LevelCountMap::Theme,
+                               m_difficulty, m_levelIndex));
 
-    std::vector<std::uint32_t> forProbs(area);
-
-    auto cmfunc = [&area](std::vector<std::uint32_t>& vect, const std::uint32_t* cm) {
-        std::size_t cmi = 0;
-        for (std::size_t ii = 0; cmi < area; ii += 2) {
-            std::uint32_t what = cm[ii + 1];
-            for (std::uint32_t j = 0; j < cm[ii]; ++j, ++cmi)
-                vect[cmi] = what;
-        }
-    };
-
-    m_initialObjectMemory.resize(area);
-
-    cmfunc(m_currentThemes, m_levels.getLevelCountMap(LevelCountMap::Theme,
-           m_difficulty, m_levelIndex));
-    cmfunc(m_currentObjPairIndices, m_levels.getLevelCountMap(LevelCountMap::ObjPair,
-           m_difficulty, m_levelIndex));
-    cmfunc(m_currentObjParams, m_levels.getLevelCountMap(LevelCountMap::Param,
-           m_difficulty, m_levelIndex));
-    cmfunc(m_initialObjectMemory, m_levels.getLevelCountMap(LevelCountMap::Memory,
-           m_difficulty, m_levelIndex));
-    cmfunc(forProbs, m_levels.getLevelCountMap(LevelCountMap::SnakeStartPos,
-           m_difficulty, m_levelIndex));
-
-    fwkCreate(m_currentSnakePosProbs, forProbs.data(), forProbs.size());
-
-    for (int i = 0; i < ItemCount; ++i) {
-        cmfunc(forProbs, m_levels.getItemProbCountMap(EatableItem(i),
-               m_difficulty, m_levelIndex));
-        m_currentItemProbabilities[i].create(mapSize, forProbs.data());
-    }
-
-    levelPtrs.objectPairIndices = m_currentObjPairIndices.data();
-    levelPtrs.objectParams = m_currentObjParams.data();
-    levelPtrs.snakePositionProbs = &m_currentSnakePosProbs;
-
-    std::array<Randomizer*, RandomTypeCount> allRands{};
-    allRands.fill(&m_randomizer);
-
-    std::array<const Map<std::uint32_t>*, ItemCount> itemProbPtrs{};
-    std::transform(m_currentItemProbabilities.begin(),
-                   m_currentItemProbabilities.end(),
-                   itemProbPtrs.begin(),
-                   [](const Map<std::uint32_t>& src) { return &src; });
-
-    m_game.restart(
-        GameImpl{ levelPtrs, allRands.data(), m_initialObjectMemory.data(), itemProbPtrs.data() });
+    std::array<Randomizer*, RandomTypeCount> allRands = m_gameRandomizers.getPointers();
+    m_game.restart(m_levelSetup.createGameImpl(allRands.data()));
 }
 
 
 void BlockSnake::playGameMusic() {
   // Some links
     const std::uint32_t* plotPtr =
-        m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+        m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
 
     if (plotPtr[(int)LevelPlotDataEnum::MusicEnabled] &&
         plotPtr[(int)LevelPlotDataEnum::MusicIndex] < m_musicTitles.size() &&
@@ -2776,92 +2659,19 @@ void BlockSnake::updateGame() {
 
 
 sf::IntRect BlockSnake::getInnerVisibleZone() const {
-  // Some links (constant!)
-    const std::uint32_t* plotPtr =
-        m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
-    sf::Vector2i mapSize{ m_levels.getMapSize(m_difficulty, m_levelIndex) };
-
-    const GameImpl& gameImpl = m_game.getImpl();
-    const SnakeWorld& snakeWorld = gameImpl.getSnakeWorld();
-    sf::Vector2i snakePos = snakeWorld.getCurrentSnakePosition();
-
-    ///////////////////////////////////////////////////////////////////////////
-
-    // corners
-
-    sf::Vector2i leftTopInMap = snakePos;
-    leftTopInMap.x -= plotPtr[(int)LevelPlotDataEnum::SnakeSightX];
-    leftTopInMap.y -= plotPtr[(int)LevelPlotDataEnum::SnakeSightY];
-
-    sf::Vector2i rightDownInMap = snakePos;
-    rightDownInMap.x += plotPtr[(int)LevelPlotDataEnum::SnakeSightX];
-    rightDownInMap.y += plotPtr[(int)LevelPlotDataEnum::SnakeSightY];
-
-    bool cameraStopped = isCameraStopped(m_nowTime);
-
-    if (!cameraStopped) {
-        switch (m_game.getImpl().getSnakeWorld().getPreviousDirection()) {
-        case Direction::Up:
-            ++rightDownInMap.y;
-            break;
-        case Direction::Down:
-            --leftTopInMap.y;
-            break;
-        case Direction::Left:
-            ++rightDownInMap.x;
-            break;
-        case Direction::Right:
-            --leftTopInMap.x;
-            break;
-        default:
-            break;
-        }
-    }
-
-    // prevent camera overshift
-
-    // x
-    if (leftTopInMap.x < 0) {
-        rightDownInMap.x -= leftTopInMap.x;
-        leftTopInMap.x = 0;
-    } else if (rightDownInMap.x >= mapSize.x) {
-        sf::Vector2i previousRightDown = rightDownInMap;
-        rightDownInMap.x = mapSize.x - 1;
-        leftTopInMap += rightDownInMap - previousRightDown;
-    }
+    const SnakeWorld& snakeWorld = m_game.getImpl().getSnakeWorld();
 
-    // y
-    if (leftTopInMap.y < 0) {
-        rightDownInMap.y -= leftTopInMap.y;
-        leftTopInMap.y = 0;
-    } else if (rightDownInMap.y >= mapSize.y) {
-        sf::Vector2i previousRightDown = rightDownInMap;
-        rightDownInMap.y = mapSize.y - 1;
-        leftTopInMap += rightDownInMap - previousRightDown;
-    }
+    VisibleZone zone = getVisibleZone(m_gameData.getLevels().getMapSize(m_difficulty, m_levelIndex), getSnakeSight(),
+                                      snakeWorld.getCurrentSnakePosition(),
+                                      snakeWorld.getPreviousDirection());
 
-    return sf::IntRect(leftTopInMap, rightDownInMap +
-                       sf::Vector2i(1, 1) - leftTopInMap);
+    return sf::IntRect(zone.leftTop, zone.size);
 }
 
 
 bool BlockSnake::isCameraStopped(sf::Int64 nowTime) const {
     // detect whether the camera has stopped
-
-    // some info
-    const std::uint32_t* plotPtr =
-        m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
-
-    const sf::Vector2u& mapSize = m_levels.getMapSize(m_difficulty, m_levelIndex);
-
-    const GameImpl& gameImpl = m_game.getImpl();
-    const SnakeWorld& snakeWorld = gameImpl.getSnakeWorld();
-
-    Direction prevDir = snakeWorld.getPreviousDirection();
-
-    // snake stands
-    if (prevDir == Direction::Count)
-        return true;
+    const SnakeWorld& snakeWorld = m_game.getImpl().getSnakeWorld();
 
     // snake delaying
     //sf::Int64 delta = nowTime - m_lastMoveEventTimePoint;
@@ -2871,46 +2681,23 @@ bool BlockSnake::isCameraStopped(sf::Int64 nowTime) const {
     //if (delta >= factualPer)
     //    return true;
 
-    // camera collided with border?
-
-    const sf::Vector2i& snakePosition = snakeWorld.getCurrentSnakePosition();
-    sf::Vector2i mapSizei(mapSize);
-
-    using Lpde = LevelPlotDataEnum;
+    return CrazySnakes::isCameraStopped(m_gameData.getLevels().getMapSize(m_difficulty, m_levelIndex), getSnakeSight(),
+                                        snakeWorld.getCurrentSnakePosition(),
+                                        snakeWorld.getPreviousDirection());
+}
 
-    switch (prevDir) {
-    case Direction::Up:
-        return (snakePosition.y <
-                (std::int64_t)plotPtr[(int)Lpde::SnakeSightY]) ||
-            (snakePosition.y + 1 >=
-             mapSizei.y - (std::int64_t)plotPtr[(int)Lpde::SnakeSightY]);
-    case Direction::Right:
-        return (snakePosition.x <
-                (std::int64_t)plotPtr[(int)Lpde::SnakeSightX] + 1) ||
-            (snakePosition.x >=
-             mapSizei.x - (std::int64_t)plotPtr[(int)Lpde::SnakeSightX]);
-    case Direction::Down:
-        return (snakePosition.y <
-                (std::int64_t)plotPtr[(int)Lpde::SnakeSightY] + 1) ||
-            (snakePosition.y >=
-             mapSizei.y - (std::int64_t)plotPtr[(int)Lpde::SnakeSightY]);
-    case Direction::Left:
-        return (snakePosition.x <
-                (std::int64_t)plotPtr[(int)Lpde::SnakeSightX]) ||
-            (snakePosition.x + 1 >=
-             mapSizei.x - (std::int64_t)plotPtr[(int)Lpde::SnakeSightX]);
-    default:
-        break;
-    }
 
+sf::Vector2i BlockSnake::getSnakeSight() const {
+    const std::uint32_t* plotPtr =
+        m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
 
-    assert(false);
-    return false;
+    return sf::Vector2i((int)plotPtr[(int)LevelPlotDataEnum::SnakeSightX],
+                        (int)plotPtr[(int)LevelPlotDataEnum::SnakeSightY]);
 }
 
 
 void BlockSnake::updateUnits() {
-    const sf::Vector2u& mapSize = m_levels.getMapSize(m_difficulty, m_levelIndex);
+    const sf::Vector2u& mapSize = m_gameData.getLevels().getMapSize(m_difficulty, m_levelIndex);
 
     sf::IntRect innerZone = getInnerVisibleZone();
     sf::Vector2i leftTopInMap(innerZone.left, innerZone.top);
@@ -3163,7 +2950,7 @@ void BlockSnake::updateUnits() {
 
 
 void BlockSnake::updateSnakeDrawable() {
-    const sf::Vector2u& mapSize = m_levels.getMapSize(m_difficulty, m_levelIndex);
+    const sf::Vector2u& mapSize = m_gameData.getLevels().getMapSize(m_difficulty, m_levelIndex);
 
     sf::IntRect innerZone = getInnerVisibleZone();
     sf::Vector2i leftTopInMap(innerZone.left, innerZone.top);
@@ -3217,7 +3004,7 @@ void BlockSnake::updateSnakeDrawable() {
 void BlockSnake::scaleUpdate() {
   // Some links
     const std::uint32_t* attribPtr =
-        m_levels.getLevelAttribPtr(m_difficulty, m_levelIndex);
+        m_gameData.getLevels().getLevelAttribPtr(m_difficulty, m_levelIndex);
     const Game::GameEventProcessor& evProc = m_game.getEventProcessor();
     const GameImpl& gameImpl = m_game.getImpl();
     const SnakeWorld& snakeWorld = gameImpl.getSnakeWorld();
@@ -3242,7 +3029,7 @@ void BlockSnake::scaleUpdate() {
         std::size_t efflostev = (std::size_t)(MainGameEvent::EffectEnded);
         sf::Int64 timeev = evProc.getTimeToEvent(efflostev);
         float effectLtNorm = float(timeev) /
-            m_levels.getEffectDurationPtr(m_difficulty, m_levelIndex)[(int)gameImpl.getEffect()];
+            m_gameData.getLevels().getEffectDurationPtr(m_difficulty, m_levelIndex)[(int)gameImpl.getEffect()];
         m_gameDrawable.setEffectScale(effectLtNorm);
     }
 
@@ -3258,7 +3045,7 @@ void BlockSnake::scaleUpdate() {
 void BlockSnake::checkLevelCompleted() {
   // Some links
     const std::uint32_t* plotPtr =
-        m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+        m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
 
     unsigned int whatCount = 0;
 
@@ -3367,8 +3154,8 @@ BlockSnake::getPositionOfCircleEntry(Direction dir,
 void BlockSnake::drawWindow() {
     const auto& evProc = m_game.getEventProcessor();
     const auto& gameImpl = m_game.getImpl();
-    const auto& mapSize = m_levels.getMapSize(m_difficulty, m_levelIndex);
-    const auto* attribPtr = m_levels.getLevelAttribPtr(m_difficulty, m_levelIndex);
+    const auto& mapSize = m_gameData.getLevels().getMapSize(m_difficulty, m_levelIndex);
+    const auto* attribPtr = m_gameData.getLevels().getLevelAttribPtr(m_difficulty, m_levelIndex);
     const auto& snakeWorld = gameImpl.getSnakeWorld();
     Direction previousDirection = snakeWorld.getPreviousDirection();
     auto& snakeCrc = m_gameDrawable.snakeCircle;
@@ -3743,22 +3530,22 @@ void BlockSnake::drawWindow() {
 
     using Lpde = LevelPlotDataEnum;
 
-    states.blendMode.alphaDstFactor = (sf::BlendMode::Factor)m_levels
+    states.blendMode.alphaDstFactor = (sf::BlendMode::Factor)m_gameData.getLevels()
         .getLevelPlotDataPtr(m_difficulty,
                              m_levelIndex)[(std::size_t)Lpde::FoggBlendDstAlpha];
-    states.blendMode.alphaSrcFactor = (sf::BlendMode::Factor)m_levels
+    states.blendMode.alphaSrcFactor = (sf::BlendMode::Factor)m_gameData.getLevels()
         .getLevelPlotDataPtr(m_difficulty,
                              m_levelIndex)[(std::size_t)Lpde::FoggBlendSrcAlpha];
-    states.blendMode.alphaEquation = (sf::BlendMode::Equation)m_levels
+    states.blendMode.alphaEquation = (sf::BlendMode::Equation)m_gameData.getLevels()
         .getLevelPlotDataPtr(m_difficulty,
                              m_levelIndex)[(std::size_t)Lpde::FoggBlendAlphaEq];
-    states.blendMode.colorDstFactor = (sf::BlendMode::Factor)m_levels
+    states.blendMode.colorDstFactor = (sf::BlendMode::Factor)m_gameData.getLevels()
         .getLevelPlotDataPtr(m_difficulty,
                              m_levelIndex)[(std::size_t)Lpde::FoggBlendDstColor];
-    states.blendMode.colorSrcFactor = (sf::BlendMode::Factor)m_levels
+    states.blendMode.colorSrcFactor = (sf::BlendMode::Factor)m_gameData.getLevels()
         .getLevelPlotDataPtr(m_difficulty,
                              m_levelIndex)[(std::size_t)Lpde::FoggBlendSrcColor];
-    states.blendMode.colorEquation = (sf::BlendMode::Equation)m_levels
+    states.blendMode.colorEquation = (sf::BlendMode::Equation)m_gameData.getLevels()
         .getLevelPlotDataPtr(m_difficulty,
                              m_levelIndex)[(std::size_t)Lpde::FoggBlendColorEq];
 
@@ -3832,8 +3619,8 @@ sf::Vector2f BlockSnake::getCameraBias(sf::Int64 now) const {
     }
     
     // some info
-    const std::uint32_t* plotPtr = m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
-    sf::Vector2i mapSize{ m_levels.getMapSize(m_difficulty, m_levelIndex) };
+    const std::uint32_t* plotPtr = m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+    sf::Vector2i mapSize{ m_gameData.getLevels().getMapSize(m_difficulty, m_levelIndex) };
     const sf::Vector2i& snakePosition = m_game.getImpl().getSnakeWorld().getCurrentSnakePosition();
 
     if (isCameraStopped(now)) {
@@ -3894,7 +3681,7 @@ sf::Vector2f BlockSnake::getCameraBias(sf::Int64 now) const {
 
 
 void BlockSnake::updateItems(EatableItem item) {
-    const std::uint32_t* plotPtr = m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+    const std::uint32_t* plotPtr = m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
 
     const GameImpl& gameImpl = m_game.getImpl();
     const SnakeWorld& snakeWorld = gameImpl.getSnakeWorld();
@@ -4064,9 +3851,9 @@ void BlockSnake::updateItems(EatableItem item) {
 
 
 void BlockSnake::drawScreens(sf::RenderStates states, float shaderSecs) {
-    const Game::GameEventProcessor evProc = m_game.getEventProcessor();
+    const Game::GameEventProcessor& evProc = m_game.getEventProcessor();
     const std::uint32_t* attribPtr =
-        m_levels.getLevelAttribPtr(m_difficulty, m_levelIndex);
+        m_gameData.getLevels().getLevelAttribPtr(m_difficulty, m_levelIndex);
 
     VisualEffect screenve;
 
@@ -4088,7 +3875,7 @@ void BlockSnake::drawScreens(sf::RenderStates states, float shaderSecs) {
 
 void BlockSnake::drawScales() {
     const std::uint32_t* plotPtr =
-        m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+        m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
     const SnakeWorld& snakeWorld = m_game.getImpl().getSnakeWorld();
 
     if (plotPtr[(int)LevelPlotDataEnum::BonusScaleVisible] && !snakeWorld.getBonusPositions().empty())
@@ -4104,9 +3891,9 @@ void BlockSnake::drawScales() {
 
 void BlockSnake::drawChallVis(float shaderSecs) {
     const std::uint32_t* plotPtr =
-        m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+        m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
     const std::uint32_t* attribPtr =
-        m_levels.getLevelAttribPtr(m_difficulty, m_levelIndex);
+        m_gameData.getLevels().getLevelAttribPtr(m_difficulty, m_levelIndex);
 
     std::uint32_t fruitCountToBonus =
         attribPtr[(int)LevelAttribEnum::FruitCountToBonus];
@@ -4263,24 +4050,23 @@ void BlockSnake::processEvents() {
             } else if (event.key.scancode == sf::Keyboard::Scancode::W ||
                         event.key.code == sf::Keyboard::Up ||
                        event.key.scancode == sf::Keyboard::Scancode::Numpad8) {
-                m_game.pushCommand(m_nowTime, Direction::Up);
-                m_rotatedPostEffect = false;
+                pushCommand(Direction::Up);
             } else if (event.key.scancode == sf::Keyboard::Scancode::A ||
                         event.key.code == sf::Keyboard::Left ||
                        event.key.scancode == sf::Keyboard::Scancode::Numpad4) {
-                m_game.pushCommand(m_nowTime, Direction::Left);
-                m_rotatedPostEffect = false;
+                pushCommand(Direction::Left);
             } else if (event.key.scancode == sf::Keyboard::Scancode::S ||
                         event.key.code == sf::Keyboard::Down ||
                        event.key.scancode == sf::Keyboard::Scancode::Numpad5 ||
                        event.key.scancode == sf::Keyboard::Scancode::Numpad2) {
-                m_game.pushCommand(m_nowTime, Direction::Down);
-                m_rotatedPostEffect = false;
+                pushCommand(Direction::Down);
             } else if (event.key.scancode == sf::Keyboard::Scancode::D ||
                         event.key.code == sf::Keyboard::Right ||
                        event.key.scancode == sf::Keyboard::Scancode::Numpad6) {
-                m_game.pushCommand(m_nowTime, Direction::Right);
-                m_rotatedPostEffect = false;
+                pushCommand(Direction::Right);
+            } else if (event.key.code == sf::Keyboard::F9) {
+                m_autopilotEnabled = !m_autopilotEnabled;
+                resetAutopilot();
             } else if (event.key.code == sf::Keyboard::P) {
                 m_settings[(std::size_t)SettingEnum::SnakeHeadPointerEnabled] =
                     (std::uint32_t)!static_cast<bool>(
@@ -4314,10 +4100,15 @@ void BlockSnake::processGameEvents() {
 
     auto dic = [this](ColorDst dst) {return getDestinationIntColor(dst); };
 
-    Game::Event gameEvent;
-    bool anyGameEvent = false;
-    while (m_game.pollEvent(gameEvent)) {
-        anyGameEvent = true;
+    // the whole frame at once, the buffer only grows
+    if (m_gameEvents.size() < m_game.getEventCount())
+        m_gameEvents.resize(m_game.getEventCount());
+
+    std::size_t gameEventCount = m_game.pollEvents(m_gameEvents.data(), m_gameEvents.size());
+    bool anyGameEvent = (gameEventCount != 0);
+
+    for (std::size_t i = 0; i < gameEventCount; ++i) {
+        const Game::Event& gameEvent = m_gameEvents[i];
 
         SoundThrower::Parameters soundParam;
         soundParam.volume = m_settings[(std::size_t)SettingEnum::SoundVolumePer10000] / 100.f;
@@ -4357,6 +4148,7 @@ void BlockSnake::processGameEvents() {
 
                 m_rotatedPostEffect = false;
                 m_currStepCount++;
+                m_replay.addStep(gameEvent.checksum);
                 m_lastMoveEventTimePoint = gameEvent.time;
 
                 // HACK
@@ -4462,7 +4254,7 @@ void BlockSnake::processGameEvents() {
                 m_particleNeedUpdatePosition = true;
 
                 m_currBonusEatenCount++;
-                m_currScore += m_levels.getLevelPlotDataPtr(m_difficulty,
+                m_currScore += m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty,
                                                             m_levelIndex)[(int)LevelPlotDataEnum::BonusScoreCoeff];
                 break;
             case GameSubevent::EffectAppended:
@@ -4480,7 +4272,7 @@ void BlockSnake::processGameEvents() {
                 m_particleNeedUpdatePosition = true;
 
                 m_currFruitEatenCount++;
-                m_currScore += m_levels.getLevelPlotDataPtr(m_difficulty,
+                m_currScore += m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty,
                                                             m_levelIndex)[(int)LevelPlotDataEnum::FruitScoreCoeff];
                 break;
             case GameSubevent::Killed:
@@ -4514,7 +4306,7 @@ void BlockSnake::processGameEvents() {
 
                 m_currPowerupEatenCount++;
                 m_currScore +=
-                    m_levels.getLevelPlotDataPtr(m_difficulty,
+                    m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty,
                                                  m_levelIndex)[(int)LevelPlotDataEnum::SuperbonusScoreCoeff];
                 break;
             case GameSubevent::RotatedPostEffect:
@@ -4552,9 +4344,38 @@ void BlockSnake::processGameEvents() {
 }
 
 
+void BlockSnake::pushCommand(Direction direction) {
+    m_game.pushCommand(m_nowTime, direction);
+    m_replay.addCommand(m_nowTime, direction);
+    m_rotatedPostEffect = false;
+}
+
+
+void BlockSnake::resetAutopilot() {
+    const std::uint32_t* plotPtr = m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+
+    m_autopilot.reset(m_game.getImpl(), (ChallengeType)plotPtr[(int)LevelPlotDataEnum::Challenge]);
+    m_autopilotCommandDue = true;
+}
+
+
+void BlockSnake::updateAutopilot() {
+    if (!m_autopilotEnabled || !m_game.getImpl().isSnakeAlive())
+        return;
+
+    // a command right after every step
+    if (!m_autopilotCommandDue && m_autopilotStepCount == m_currStepCount)
+        return;
+
+    m_autopilotCommandDue = false;
+    m_autopilotStepCount = m_currStepCount;
+    pushCommand(m_autopilot.getCommand());
+}
+
+
 void BlockSnake::endGame() {
   // Some links
-    const std::uint32_t* plotPtr = m_levels.getLevelPlotDataPtr(m_difficulty, m_levelIndex);
+    const std::uint32_t* plotPtr = m_gameData.getLevels().getLevelPlotDataPtr(m_difficulty, m_levelIndex);
 
     m_currGameTimeElapsed = m_gameClock.getElapsedTime<sf::Int64, std::micro>();
 
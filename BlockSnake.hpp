@@ -26,13 +26,14 @@
 #ifndef BLOCK_SNAKE_HPP
 #define BLOCK_SNAKE_HPP
 #include "Game.hpp"
-#include "Levels.hpp"
+#include "GameData.hpp"
 #include "LevelStatistics.hpp"
 #include "GameDrawable.hpp"
 #include "PausableClock.hpp"
-#include "RandomizerImpl.hpp"
+#include "Randomizer.hpp"
+#include "Replay.hpp"
+#include "Autopilot.hpp"
 #include "SoundPlayer.hpp"
-#include "ObjectBehaviour.hpp"
 #include "LevelElements.hpp"
 #include <SFML/Graphics/Shader.hpp>
 #include <SFML/Audio/Music.hpp>
@@ -110,6 +111,9 @@ private:
     sf::IntRect getInnerVisibleZone() const;
     bool isCameraStopped(sf::Int64 nowTime) const;
 
+    // SnakeSightX and SnakeSightY of the level
+    sf::Vector2i getSnakeSight() const;
+
     // inner camera bias
     sf::Vector2f getCameraBias(sf::Int64 nowTime) const;
 
@@ -136,8 +140,13 @@ private:
 
     void processEvents();
     void processGameEvents();
+    void pushCommand(Direction direction);
     void endGame();
 
+    // the attract mode: the autopilot plays (toggled by F9)
+    void resetAutopilot();
+    void updateAutopilot();
+
     void pauseGame();
 
     // MEMBERS
@@ -145,10 +154,14 @@ private:
     GameDrawable m_gameDrawable; // game graphics    
     std::array<sf::Shader, VisualEffectCount> m_shaders;
     // random
-    RandomizerImpl m_randomizer;
+    Randomizer m_randomizer;          // the run seeds
+    RandomizerSet m_gameRandomizers;  // seeded for every run
     SoundPlayer m_soundPlayer;
     // main game states
     Game m_game;                 // game manager
+    std::vector<Game::Event> m_gameEvents; // events of a frame
+    Replay m_replay;             // the current game recorded
+    Autopilot m_autopilot;
     std::array<sf::Font, FontCount> m_fonts;
     sf::Cursor m_cursor; // destroy the window before destroying the cursor
     sf::RenderWindow m_window; // Window
@@ -158,22 +171,17 @@ private:
     std::array<std::uint32_t, ColorDstCount> m_colors;   // Colors
     sf::Music m_music;
     sf::Music m_ambient;
-    Levels m_levels;
+    GameData m_gameData;
     LevelStatistics m_levelStatistics;
     // current loaded map layers
-    std::array<Map<std::uint32_t>, ItemCount> m_currentItemProbabilities;
+    LevelSetup m_levelSetup;
     sf::Transform m_particleSystemTransform;
-    std::array<std::uint32_t, ObjectPairCount> m_objectPreEffects{};
-    std::array<std::uint32_t, ObjectPairCount> m_objectPostEffects{};
-    std::array<std::uint32_t, ObjectPairCount> m_objectTailCapacities1{};
     sf::Texture m_digitTexture;
     std::array<std::uint32_t, SettingCount> m_settings{};
 public:
     std::string pwd;
 private:
     sf::Image m_iconImg;
-    std::vector<ObjectBehaviour> m_objectBehaviours;
-    std::vector<std::uint32_t> m_initialObjectMemory;
     // localization
     std::vector<sf::String> m_words;
     std::vector<std::filesystem::path>
@@ -184,9 +192,6 @@ private:
         m_fontTitles, 
         m_languageTitles, 
         m_wallpaperTitles;
-    std::vector<std::uintmax_t> m_currentSnakePosProbs;
-    std::vector<std::uint32_t> m_currentObjPairIndices;
-    std::vector<std::uint32_t> m_currentObjParams;
     std::vector<std::uint32_t> m_currentThemes;
     PausableClock m_gameClock;   // game clock
     std::shared_ptr<sf::Texture> m_menuWallpaper; // 'zero'
@@ -229,6 +234,7 @@ private:
     unsigned int m_currBonusEatenCount = 0;
     unsigned int m_currPowerupEatenCount = 0;
     unsigned int m_currStepCount = 0;
+    unsigned int m_autopilotStepCount = 0; // the step the autopilot has given the command after
     // is current level completed for this moment
     bool m_levelComplete = false;
     bool m_particleNeedUpdatePosition = false;
@@ -237,6 +243,8 @@ private:
 
     // for implementing forced snake turn
     bool m_rotatedPostEffect = false;
+    bool m_autopilotEnabled = false;
+    bool m_autopilotCommandDue = false;
 // dirty hack
     bool m_movingReserved = false;
     bool m_movingReserved2 = false;
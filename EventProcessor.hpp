@@ -25,16 +25,20 @@
 
 #ifndef EVENT_PROCESSOR_HPP
 #define EVENT_PROCESSOR_HPP
+#include "TimerHeap.hpp"
 #include <cstddef>
-#include <array>
 
 namespace CrazySnakes {
 
 // just few timers
+// The times are relative to the current one, the deadlines are kept absolute
+// (see TimerHeap), so going on doesn't touch the timers but the passed ones.
 template<class time_t, class mask_t, std::size_t N>
 class EventProcessor {
 public:
 
+    static_assert(N <= sizeof(mask_t) * 8, "the events don't fit the mask");
+
     static constexpr time_t NotActive = time_t();
 
     EventProcessor() noexcept;
@@ -56,10 +60,10 @@ public:
 // the soonest gone
     void goToEvent() noexcept;
 
-    // just go and ignore everything
+    // just go and ignore everything (the passed events are gone)
     void goTo(time_t through) noexcept;
 
-    // newbie
+    // newbie (inactive if the time isn't positive)
     void addFutureEvent(std::size_t mainEvent, time_t time) noexcept;
 
     // no events
@@ -67,18 +71,8 @@ public:
 
 private:
 
-    // find the soonest time
-    void updateLessTime() const noexcept;
-
-    // find the soonest events
-    void updateNextEventMask() const noexcept;
-
-    std::array<time_t, N> m_eventTimes;           //!< Clocks for events
-
-    mutable time_t m_lessTime;            //!< Cached time to next event
-    mutable mask_t m_nextEvents;
-    mutable bool m_updatedNextEvents;
-    mutable bool m_updatedLessTime;        //!< Should use the cached time to next event
+    TimerHeap<time_t, N> m_timers; //!< Absolute deadlines of the events
+    time_t m_now;                  //!< Time gone since clear
 };
 
 template<class time_t, class mask_t, std::size_t N>
@@ -88,19 +82,23 @@ inline EventProcessor<time_t, mask_t, N>::EventProcessor() noexcept {
 
 template<class time_t, class mask_t, std::size_t N>
 inline time_t EventProcessor<time_t, mask_t, N>::getTimeToNextEvent() const noexcept {
-    updateLessTime();
-    return m_lessTime;
+    return m_timers.empty() ? NotActive : m_timers.getTopDeadline() - m_now;
 }
 
 template<class time_t, class mask_t, std::size_t N>
 inline mask_t EventProcessor<time_t, mask_t, N>::getNextEvent() const noexcept {
-    updateNextEventMask();
-    return m_nextEvents;
+    mask_t nextEvents = mask_t();
+
+    if (!m_timers.empty())
+        m_timers.forEachDue(m_timers.getTopDeadline(),
+                            [&nextEvents](std::size_t i) { nextEvents |= (mask_t(1) << i); });
+
+    return nextEvents;
 }
 
 template<class time_t, class mask_t, std::size_t N>
 inline time_t EventProcessor<time_t, mask_t, N>::getTimeToEvent(std::size_t theEvent) const noexcept {
-    return m_eventTimes[theEvent];
+    return m_timers.isActive(theEvent) ? m_timers.getDeadline(theEvent) - m_now : NotActive;
 }
 
 template<class time_t, class mask_t, std::size_t N>
@@ -110,60 +108,26 @@ inline void EventProcessor<time_t, mask_t, N>::goToEvent() noexcept {
 
 template<class time_t, class mask_t, std::size_t N>
 inline void EventProcessor<time_t, mask_t, N>::goTo(time_t through) noexcept {
-    for (std::size_t i = 0; i < N; ++i)
-        if (m_eventTimes[i] != NotActive && through <= m_eventTimes[i])
-            m_eventTimes[i] -= through;
+    m_now += through;
 
-    m_updatedLessTime = false;
-    m_updatedNextEvents = false;
+    while (!m_timers.empty() && !(m_now < m_timers.getTopDeadline()))
+        m_timers.pop();
 }
 
 template<class time_t, class mask_t, std::size_t N>
 inline void EventProcessor<time_t, mask_t, N>::addFutureEvent(std::size_t mainEvent, time_t time) noexcept {
-    m_eventTimes[mainEvent] = std::max(time, NotActive);
-    m_updatedLessTime = false;
-    m_updatedNextEvents = false;
+    if (time > NotActive)
+        m_timers.schedule(mainEvent, m_now + time);
+    else
+        m_timers.cancel(mainEvent);
 }
 
 template<class time_t, class mask_t, std::size_t N>
 inline void EventProcessor<time_t, mask_t, N>::clear() noexcept {
-    m_eventTimes.fill(NotActive);
-    m_lessTime = NotActive;
-    m_nextEvents = mask_t();
-    m_updatedLessTime = true;
-    m_updatedNextEvents = true;
-}
-
-template<class time_t, class mask_t, std::size_t N>
-inline void EventProcessor<time_t, mask_t, N>::updateLessTime() const noexcept {
-    if (!m_updatedLessTime) {
-        time_t minimum = NotActive;
-
-        for (std::size_t i = 0; i < N; ++i)
-            if (m_eventTimes[i] < minimum && m_eventTimes[i] > NotActive || minimum == NotActive)
-                minimum = m_eventTimes[i];
-
-        m_lessTime = minimum;
-        m_updatedLessTime = true;
-    }
-}
-
-template<class time_t, class mask_t, std::size_t N>
-inline void EventProcessor<time_t, mask_t, N>::updateNextEventMask() const noexcept {
-    if (!m_updatedNextEvents) {
-        time_t lessTime = getTimeToNextEvent();
-        m_nextEvents = mask_t();
-
-        if (lessTime != NotActive) {
-            for (std::size_t i = 0; i < N; ++i)
-                if (m_eventTimes[i] == lessTime)
-                    m_nextEvents |= (mask_t(1) << i);
-        }
-
-        m_updatedNextEvents = true;
-    }
+    m_timers.clear();
+    m_now = NotActive;
 }
 
 }
 
-#endif // !EVENT_PROCESSOR_HPP
\ No newline at end of file
+#endif // !EVENT_PROCESSOR_HPP
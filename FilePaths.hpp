@@ -54,6 +54,7 @@ const ResourcePath DATA_PATH = "Resources/data.bin";
 const ResourcePath STATUS_PATH = "Resources/status.bin";
 
 const ResourcePath LOG_PATH = "logs.log";
+const ResourcePath LAST_REPLAY_PATH = "last_replay.bin";
 
 }
 
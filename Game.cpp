@@ -25,6 +25,19 @@
 
 #include "Game.hpp"
 #include "AttribEnums.hpp"
+#include <algorithm>
+
+namespace {
+
+// not for security, just to see the divergence
+std::uint64_t mixChecksum(std::uint64_t checksum, std::uint64_t value) noexcept {
+    checksum ^= value + 0x9e3779b97f4a7c15u + (checksum << 6) + (checksum >> 2);
+    checksum ^= checksum >> 31;
+    checksum *= 0xbf58476d1ce4e5b9u;
+    return checksum ^ (checksum >> 29);
+}
+
+}
 
 namespace CrazySnakes {
 
@@ -86,6 +99,12 @@ bool Game::pollEvent(Event& event) noexcept {
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t Game::pollEvents(Event* events, std::size_t maxCount) noexcept {
+    return m_eventQueue.popTo(events, maxCount);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void Game::update(std::int64_t now) {
     bool again = true; // We have to run through all following events
@@ -130,7 +149,10 @@ void Game::update(std::int64_t now) {
 
                 m_rotationEvents.pop_front();
             } else {
-                processOuterEvent(eventTime);
+                // the steps at the time of the command go before it
+                std::int64_t until = (earliestRBP ? std::min(now, rbpClockTime) : now);
+                if (!fastForward(eventTime, until, eventTime))
+                    processOuterEvent(eventTime);
             }
 
             // update the event time
@@ -216,7 +238,7 @@ void Game::processOuterEvent(std::int64_t eventTimePoint) {
         m_impl.finishEffect();
     }
     if (events & (MAX_ONE << (int)MainGameEvent::TimeLimitExceed)) {
-        m_impl.killSnake();
+        m_impl.killSnake(DeathCause::TimeLimit);
     }
 
     // We prefer to push events after moving
@@ -232,11 +254,8 @@ void Game::processOuterEvent(std::int64_t eventTimePoint) {
     commonMainEvent.time = eventTimePoint;
     commonSubevent.time = eventTimePoint;
 
-    if (events & (MAX_ONE << (int)MainGameEvent::Moved)) {
-        Event movedEvent = commonMainEvent;
-        movedEvent.mainGameEvent = MainGameEvent::Moved;
-        m_eventQueue.push_back(movedEvent);
-    }
+    if (events & (MAX_ONE << (int)MainGameEvent::Moved))
+        pushMovedEvent(eventTimePoint, subevs);
 
     if (subevs & (MAX_ONE << (int)GameSubevent::FruitEaten)) {
         Event fruitEatenEvent = commonSubevent;
@@ -305,6 +324,8 @@ void Game::processOuterEvent(std::int64_t eventTimePoint) {
         m_eventQueue.push_back(effectAppendedEvent);
     }
 
+    events &= m_mainEventMask;
+
     if (events & (MAX_ONE << (int)MainGameEvent::BonusExceed)) {
         Event bonusLostEvent = commonMainEvent;
         bonusLostEvent.mainGameEvent = MainGameEvent::BonusExceed;
@@ -338,10 +359,102 @@ void Game::processOuterEvent(std::int64_t eventTimePoint) {
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Game::fastForward(std::int64_t firstStepTime, std::int64_t until, std::int64_t& lastStepTime) {
+    constexpr std::uintmax_t MAX_ONE = 1;
+
+    if (m_eventProcessor.getNextEvent() != (MAX_ONE << (int)MainGameEvent::Moved))
+        return false;
+
+    // the steps meeting the other timers go the usual way
+    for (std::size_t i = 0; i < MainEventCount; ++i) {
+        std::int64_t timeToEvent = m_eventProcessor.getTimeToEvent(i);
+        if (i != (std::size_t)MainGameEvent::Moved && timeToEvent != GameEventProcessor::NotActive)
+            until = std::min(until, m_lastUpdateTimePoint + timeToEvent - 1);
+    }
+
+    // the period holds while the steps are quiet
+    std::int64_t period = m_impl.getFactualSnakePeriod();
+    if (period <= 0 || until - firstStepTime < period * (std::int64_t)(MinFastForwardSteps - 1))
+        return false;
+
+    std::uintmax_t stepCount = m_impl.getQuietStepCount((std::uintmax_t)((until - firstStepTime) / period) + 1);
+    if (stepCount < MinFastForwardSteps)
+        return false;
+
+    lastStepTime = firstStepTime;
+    for (std::uintmax_t i = 0; i < stepCount; ++i) {
+        if (i)
+            lastStepTime += period;
+        pushMovedEvent(lastStepTime, m_impl.moveQuietly());
+    }
+
+    // as if every step went by processOuterEvent
+    m_eventProcessor.goTo(lastStepTime - m_lastUpdateTimePoint);
+    m_eventProcessor.addFutureEvent((std::size_t)MainGameEvent::Moved, period);
+    return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void Game::pushMovedEvent(std::int64_t eventTimePoint, std::uintmax_t subevents) {
+    constexpr std::uintmax_t MAX_ONE = 1;
+
+    const SnakeWorld& snakeWorld = m_impl.getSnakeWorld();
+    const sf::Vector2i& position = snakeWorld.getCurrentSnakePosition();
+
+    m_stepChecksum = mixChecksum(m_stepChecksum, (std::uint64_t)eventTimePoint);
+    m_stepChecksum = mixChecksum(m_stepChecksum, subevents);
+    m_stepChecksum = mixChecksum(m_stepChecksum, (std::uint64_t)(std::uint32_t)position.x << 32 |
+                                 (std::uint32_t)position.y);
+    m_stepChecksum = mixChecksum(m_stepChecksum, snakeWorld.getTailSize());
+    m_stepChecksum = mixChecksum(m_stepChecksum, (std::uint64_t)m_impl.getSnakeDirection() << 16 |
+                                 (std::uint64_t)m_impl.getSnakeAcceleration() << 8 |
+                                 (std::uint64_t)m_impl.getEffect());
+
+    if (!(m_mainEventMask & (MAX_ONE << (int)MainGameEvent::Moved)))
+        return;
+
+    Event movedEvent{};
+    movedEvent.isMain = true;
+    movedEvent.unpredMemory = (subevents >> 32);
+    movedEvent.time = eventTimePoint;
+    movedEvent.mainGameEvent = MainGameEvent::Moved;
+    movedEvent.checksum = m_stepChecksum;
+    m_eventQueue.push_back(movedEvent);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void Game::takeSnapshot(Snapshot& snapshot) {
+    m_impl.takeSnapshot(snapshot.m_impl);
+    snapshot.m_eventProcessor = m_eventProcessor;
+    snapshot.m_eventQueue = m_eventQueue;
+    snapshot.m_rotationEvents = m_rotationEvents;
+    snapshot.m_lastUpdateTimePoint = m_lastUpdateTimePoint;
+    snapshot.m_stepChecksum = m_stepChecksum;
+}
+
+
+void Game::restoreSnapshot(const Snapshot& snapshot) {
+    m_impl.restoreSnapshot(snapshot.m_impl);
+    m_eventProcessor = snapshot.m_eventProcessor;
+    m_eventQueue = snapshot.m_eventQueue;
+    m_rotationEvents = snapshot.m_rotationEvents;
+    m_lastUpdateTimePoint = snapshot.m_lastUpdateTimePoint;
+    m_stepChecksum = snapshot.m_stepChecksum;
+}
+
+
+void Game::dropSnapshots() {
+    m_impl.dropSnapshots();
+}
+
+
 void Game::innerRestart() noexcept {
     m_lastUpdateTimePoint = 0;
-    std::list<Event>().swap(m_eventQueue);
-    std::list<RotationEvent>().swap(m_rotationEvents);
+    m_stepChecksum = 0;
+    m_eventQueue.clear();
+    m_rotationEvents.clear();
     m_eventProcessor.clear();
     m_eventProcessor.addFutureEvent((std::size_t)(MainGameEvent::TimeLimitExceed),
                                     m_impl.getLevelPointers()
@@ -355,8 +468,11 @@ Game::Game(Game&& src) noexcept :
     m_eventQueue(std::move(src.m_eventQueue)),
     m_impl(std::move(src.m_impl)),
     m_lastUpdateTimePoint(src.m_lastUpdateTimePoint),
-    m_rotationEvents(std::move(src.m_rotationEvents)) {
+    m_rotationEvents(std::move(src.m_rotationEvents)),
+    m_stepChecksum(src.m_stepChecksum),
+    m_mainEventMask(src.m_mainEventMask) {
     src.m_lastUpdateTimePoint = 0;
+    src.m_stepChecksum = 0;
     src.m_eventProcessor.clear();
 }
 
@@ -371,8 +487,11 @@ Game& Game::operator=(Game&& src) noexcept {
     m_impl = std::move(src.m_impl);
     m_lastUpdateTimePoint = src.m_lastUpdateTimePoint;
     m_rotationEvents = std::move(src.m_rotationEvents);
+    m_stepChecksum = src.m_stepChecksum;
+    m_mainEventMask = src.m_mainEventMask;
 
     src.m_lastUpdateTimePoint = 0;
+    src.m_stepChecksum = 0;
     src.m_eventProcessor.clear();
 
     return *this;
@@ -28,7 +28,7 @@
 #include "EventProcessor.hpp"
 #include "EventEnums.hpp"
 #include "GameImpl.hpp"
-#include <list>
+#include "RingQueue.hpp"
 
 namespace CrazySnakes {
 
@@ -48,6 +48,10 @@ public:
         // to detect unpredictable memory
         std::uint32_t unpredMemory;
 
+        // Moved: the state checksum chained over the steps since the restart,
+        // the same for the same level, randomizer seed and commands (see Replay)
+        std::uint64_t checksum;
+
         MainGameEvent mainGameEvent;
         GameSubevent subevent;
         bool isMain;
@@ -79,6 +83,8 @@ public:
         };
     };
 
+    class Snapshot;
+
     Game(const Game&) = default;
     Game(Game&&) noexcept;
 
@@ -101,14 +107,47 @@ public:
     }
 
 /// Update the game states. Fills the event queue.
+    /// The runs of quiet steps (see GameImpl::getQuietStepCount) up to now go by fast forward,
+    /// with the same states and events as one by one.
     void update(std::int64_t now);
 
+    /// The main events to queue, a bit per MainGameEvent (all by default).
+    /// The others still go on, e.g. without Moved the steps only chain the checksum.
+    void setMainEventMask(std::uintmax_t mask) noexcept {
+        m_mainEventMask = mask;
+    }
+
     /// Extract one event from the queue.
     /// If the queue is empty, the method returns false.
     [[nodiscard]] bool pollEvent(Event& event) noexcept;
 
+    /// Extract up to maxCount events from the queue at once.
+    /// Returns the count of the events written.
+    std::size_t pollEvents(Event* events, std::size_t maxCount) noexcept;
+
+    /// Events in the queue
+    std::size_t getEventCount() const noexcept {
+        return m_eventQueue.size();
+    }
+
     void pushCommand(std::int64_t now, Direction direction);
 
+    /// The same game on other randomizers (a copy uses the ones of the original)
+    void setRandomizers(Randomizer* const* randomizers) noexcept {
+        m_impl.setRandomizers(randomizers);
+    }
+
+    /// Remember the game to come back to it (a checkpoint, a branch of a search).
+    /// Since the first snapshot the engine logs its changes, so taking one costs next to nothing
+    /// and restoring one costs as much as changed since then, unlike copying the whole game.
+    /// Restoring invalidates the snapshots taken after that one, restarting invalidates all of them.
+    /// The randomizers are not a part of the game, copy them too for the same future.
+    void takeSnapshot(Snapshot& snapshot);
+    void restoreSnapshot(const Snapshot& snapshot);
+
+    /// Stop logging the changes and free the logs
+    void dropSnapshots();
+
     const GameImpl& getImpl() const noexcept {
         return m_impl;
     }
@@ -124,6 +163,15 @@ private:
     /// Process the outer event on update
     void processOuterEvent(std::int64_t eventTimePoint);
 
+    /// The quiet steps from the first one due (only Moved) until the time, inclusive.
+    /// False if there are fewer than MinFastForwardSteps of them, nothing done then.
+    bool fastForward(std::int64_t firstStepTime, std::int64_t until, std::int64_t& lastStepTime);
+
+    /// Chain the checksum of the step and queue its Moved event
+    void pushMovedEvent(std::int64_t eventTimePoint, std::uintmax_t subevents);
+
+    static constexpr std::uintmax_t MinFastForwardSteps = 2;
+
     /// Represents rotate command
     struct RotationEvent {
         std::int64_t timePoint; // Time when the command was pushed
@@ -132,9 +180,26 @@ private:
 
     GameImpl m_impl;                             // Game implementation
     GameEventProcessor m_eventProcessor;
-    std::list<Event> m_eventQueue;               // Event queue that simplifies the work with events
-    std::list<RotationEvent> m_rotationEvents;
+    RingQueue<Event> m_eventQueue;               // Event queue that simplifies the work with events
+    RingQueue<RotationEvent> m_rotationEvents;
     std::int64_t m_lastUpdateTimePoint = 0;      // Time that is ordered to game implementation status
+    std::uint64_t m_stepChecksum = 0;
+    std::uintmax_t m_mainEventMask = ~(std::uintmax_t)0; // not a part of the snapshots
+
+public:
+
+    class Snapshot {
+    private:
+
+        friend class Game;
+
+        GameImpl::Snapshot m_impl;
+        GameEventProcessor m_eventProcessor;
+        RingQueue<Event> m_eventQueue;
+        RingQueue<RotationEvent> m_rotationEvents;
+        std::int64_t m_lastUpdateTimePoint = 0;
+        std::uint64_t m_stepChecksum = 0;
+    };
 };
 
 } // namespace CrazySnakes
@@ -0,0 +1,250 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "GameData.hpp"
+#include "ObjectBehaviourLoader.hpp"
+#include "AttribEnums.hpp"
+#include "GraphicalEnums.hpp"
+#include "Endianness.hpp"
+#include <SFML/System/FileInputStream.hpp>
+#include <SFML/System/MemoryInputStream.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::optional<std::string> GameData::loadFromFile(const std::string& path,
+                                                  unsigned int diffCount,
+                                                  unsigned int levelCount) {
+    std::vector<std::uint32_t> dataInput;
+
+    sf::FileInputStream finp;
+    if (!finp.open(path))
+        return "Failed to load " + path;
+
+    sf::Int64 sz = finp.getSize();
+    if (sz % 4 != 0)
+        return path + ": wrong size";
+
+    dataInput.resize(sz / 4);
+    sf::Int64 read = finp.read(dataInput.data(), sz);
+    if (read != sz)
+        return "Failed to read " + path;
+
+    // endianness
+    std::for_each(dataInput.begin(), dataInput.end(),
+                  [](std::uint32_t& v) {
+                      v = n2hl(v);
+                  });
+
+    return loadFromMemory(dataInput.data(), dataInput.size(), diffCount, levelCount);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::optional<std::string> GameData::loadFromMemory(const std::uint32_t* data, std::size_t wordCount,
+                                                    unsigned int diffCount, unsigned int levelCount) {
+    // COLORS (not needed here)
+    if (wordCount < (std::size_t)ColorDstCount)
+        return "Color section failure";
+
+    std::size_t position = ColorDstCount;
+
+    // BEHAVIOR, decoded in place
+    std::size_t readCount = 0;
+    auto objlog{ ObjectBehaviourLoader::loadFromMemory(m_objectBehaviours, data + position,
+                                                       wordCount - position, readCount) };
+    if (objlog)
+        return objlog;
+
+    position += readCount;
+
+    m_objectTransitions.build(m_objectBehaviours);
+
+    sf::MemoryInputStream minp;
+    minp.open(data + position, (wordCount - position) * sizeof(std::uint32_t));
+    return loadObjectMapsAndLevels(minp, diffCount, levelCount, false);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::optional<std::string> GameData::loadFromStream(sf::InputStream& stream,
+                                                    unsigned int diffCount,
+                                                    unsigned int levelCount,
+                                                    bool endiannessRequired) {
+    // COLORS (not needed here)
+    std::array<std::uint32_t, ColorDstCount> colors{};
+    sf::Int64 ctntread = stream.read(colors.data(),
+                                     (sf::Int64)sizeof(std::uint32_t) * ColorDstCount);
+    if (ctntread != (sf::Int64)sizeof(std::uint32_t) * ColorDstCount)
+        return "Color section failure";
+
+    // BEHAVIOR
+    auto objlog{ ObjectBehaviourLoader::loadFromStream(m_objectBehaviours, stream, endiannessRequired) };
+    if (objlog)
+        return objlog;
+
+    m_objectTransitions.build(m_objectBehaviours);
+
+    return loadObjectMapsAndLevels(stream, diffCount, levelCount, endiannessRequired);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::optional<std::string> GameData::loadObjectMapsAndLevels(sf::InputStream& stream,
+                                                             unsigned int diffCount,
+                                                             unsigned int levelCount,
+                                                             bool endiannessRequired) {
+    // BEHAVIOR MAP
+    auto loadArray = [&stream, endiannessRequired](std::array<std::uint32_t, ObjectPairCount>& arr) {
+        sf::Int64 arrread = stream.read(arr.data(),
+                                        (sf::Int64)sizeof(std::uint32_t) * arr.size());
+        if (arrread != (sf::Int64)sizeof(std::uint32_t) * (sf::Int64)arr.size())
+            return false;
+
+        // endianness
+        if (endiannessRequired) {
+            std::for_each(arr.begin(), arr.end(),
+                          [](std::uint32_t& v) {
+                              v = n2hl(v);
+                          });
+        }
+        return true;
+    };
+
+    if (!loadArray(m_objectPreEffects))
+        return "Pre-effect section failure";
+    if (!loadArray(m_objectPostEffects))
+        return "Post-effect section failure";
+    if (!loadArray(m_objectTailCapacities1))
+        return "Tail capacity section failure";
+
+    // LEVELS
+    if (!m_levels.loadFromStream(diffCount, levelCount, stream, endiannessRequired))
+        return "Level section failure";
+
+    return {};
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void LevelSetup::create(const GameData& data, unsigned int diffIndex, unsigned int levelIndex) {
+    const Levels& levels = data.getLevels();
+
+    m_data = &data;
+    m_diffIndex = diffIndex;
+    m_levelIndex = levelIndex;
+    m_mapSize = levels.getMapSize(diffIndex, levelIndex);
+
+    std::size_t area{ (std::size_t)m_mapSize.x * m_mapSize.y };
+
+    m_objectPairIndices.resize(area);
+    m_objectParams.resize(area);
+    m_initialObjectMemory.resize(area);
+
+    std::vector<std::uint32_t> forProbs(area);
+
+    auto cmfunc = [&area](std::vector<std::uint32_t>& vect, const std::uint32_t* cm) {
+        expandCountMap(vect.data(), area, cm);
+    };
+
+    cmfunc(m_objectPairIndices, levels.getLevelCountMap(LevelCountMap::ObjPair,
+           diffIndex, levelIndex));
+    cmfunc(m_objectParams, levels.getLevelCountMap(LevelCountMap::Param,
+           diffIndex, levelIndex));
+    cmfunc(m_initialObjectMemory, levels.getLevelCountMap(LevelCountMap::Memory,
+           diffIndex, levelIndex));
+    cmfunc(forProbs, levels.getLevelCountMap(LevelCountMap::SnakeStartPos,
+           diffIndex, levelIndex));
+
+    m_snakePositionTable.build(forProbs.data(), forProbs.size());
+
+    m_specializedBehaviours.build(data.getObjectBehaviours(), data.getObjectPreEffects(),
+                                  data.getObjectPostEffects(), m_objectPairIndices.data(),
+                                  m_objectParams.data(), area);
+
+    for (int i = 0; i < ItemCount; ++i) {
+        cmfunc(forProbs, levels.getItemProbCountMap(EatableItem(i),
+               diffIndex, levelIndex));
+        m_itemProbabilities[i].create(m_mapSize, forProbs.data());
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void LevelSetup::expandCountMap(std::uint32_t* cells, std::size_t area, const std::uint32_t* countMap) noexcept {
+    std::size_t cmi = 0;
+    for (std::size_t ii = 0; cmi < area; ii += 2) {
+        std::uint32_t what = countMap[ii + 1];
+        for (std::uint32_t j = 0; j < countMap[ii]; ++j, ++cmi)
+            cells[cmi] = what;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+GameImpl::LevelPointers LevelSetup::getLevelPointers() const noexcept {
+    assert(m_data);
+
+    const Levels& levels = m_data->getLevels();
+
+    GameImpl::LevelPointers levelPtrs;
+    levelPtrs.attribArray = levels.getLevelAttribPtr(m_diffIndex, m_levelIndex);
+    levelPtrs.effectDurations = levels.getEffectDurationPtr(m_diffIndex, m_levelIndex);
+    levelPtrs.powerupProbs = &levels.getPowerupProbs(m_diffIndex, m_levelIndex);
+
+    levelPtrs.objectBehs = m_data->getObjectBehaviours().data();
+    levelPtrs.objectTransitions = &m_data->getObjectTransitions();
+    levelPtrs.specializedBehs = &m_specializedBehaviours;
+    levelPtrs.postEffectBehIndices = m_data->getObjectPostEffects();
+    levelPtrs.preEffectBehIndices = m_data->getObjectPreEffects();
+    levelPtrs.tailCapacities1 = m_data->getObjectTailCapacities1();
+
+    levelPtrs.objectPairIndices = m_objectPairIndices.data();
+    levelPtrs.objectParams = m_objectParams.data();
+    levelPtrs.snakePositionTable = &m_snakePositionTable;
+    return levelPtrs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::array<const Map<std::uint32_t>*, ItemCount> LevelSetup::getItemProbPtrs() const noexcept {
+    std::array<const Map<std::uint32_t>*, ItemCount> itemProbPtrs{};
+    std::transform(m_itemProbabilities.begin(),
+                   m_itemProbabilities.end(),
+                   itemProbPtrs.begin(),
+                   [](const Map<std::uint32_t>& src) { return &src; });
+    return itemProbPtrs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+GameImpl LevelSetup::createGameImpl(Randomizer* const* randomizers) const {
+    auto itemProbPtrs{ getItemProbPtrs() };
+    return GameImpl{ getLevelPointers(), randomizers, getInitialObjectMemory(), itemProbPtrs.data() };
+}
+
+} // namespace CrazySnakes
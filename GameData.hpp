@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef GAME_DATA_HPP
+#define GAME_DATA_HPP
+#include "GameImpl.hpp"
+#include "Levels.hpp"
+#include "LevelElements.hpp"
+#include "ObjectBehaviour.hpp"
+#include "ObjectTransitions.hpp"
+#include "SpecializedBehaviours.hpp"
+#include "AliasTable.hpp"
+#include <optional>
+#include <string>
+#include <array>
+#include <vector>
+
+namespace sf {
+class InputStream;
+}
+
+namespace CrazySnakes {
+
+/// The engine part of data.bin (no colors, textures and sounds).
+/// The game and the headless tools parse the data through it, the game reads the colors apart.
+class GameData {
+public:
+
+    [[nodiscard]] std::optional<std::string>
+        loadFromFile(const std::string& path, unsigned int diffCount, unsigned int levelCount);
+
+    [[nodiscard]] std::optional<std::string>
+        loadFromStream(sf::InputStream& stream, unsigned int diffCount,
+                       unsigned int levelCount, bool endiannessRequired);
+
+    // data: the words of data.bin in the host order; the behaviours are decoded in place
+    [[nodiscard]] std::optional<std::string>
+        loadFromMemory(const std::uint32_t* data, std::size_t wordCount,
+                       unsigned int diffCount, unsigned int levelCount);
+
+    const Levels& getLevels() const noexcept {
+        return m_levels;
+    }
+
+    const std::vector<ObjectBehaviour>& getObjectBehaviours() const noexcept {
+        return m_objectBehaviours;
+    }
+
+    const ObjectTransitions& getObjectTransitions() const noexcept {
+        return m_objectTransitions;
+    }
+
+    const std::uint32_t* getObjectPreEffects() const noexcept {
+        return m_objectPreEffects.data();
+    }
+
+    const std::uint32_t* getObjectPostEffects() const noexcept {
+        return m_objectPostEffects.data();
+    }
+
+    const std::uint32_t* getObjectTailCapacities1() const noexcept {
+        return m_objectTailCapacities1.data();
+    }
+
+private:
+
+    // the sections after the behaviours
+    [[nodiscard]] std::optional<std::string>
+        loadObjectMapsAndLevels(sf::InputStream& stream, unsigned int diffCount,
+                                unsigned int levelCount, bool endiannessRequired);
+
+    Levels m_levels;
+    std::vector<ObjectBehaviour> m_objectBehaviours;
+    ObjectTransitions m_objectTransitions;
+    std::array<std::uint32_t, ObjectPairCount> m_objectPreEffects{};
+    std::array<std::uint32_t, ObjectPairCount> m_objectPostEffects{};
+    std::array<std::uint32_t, ObjectPairCount> m_objectTailCapacities1{};
+};
+
+/// The count maps of one level expanded to the full area.
+/// It's not modified by the games, so many games can share one setup.
+class LevelSetup {
+public:
+
+    void create(const GameData& data, unsigned int diffIndex, unsigned int levelIndex);
+
+    // countMap: (count, value) pairs, run-length encoded cells of the level
+    static void expandCountMap(std::uint32_t* cells, std::size_t area, const std::uint32_t* countMap) noexcept;
+
+    // the pointers refer to this setup and the game data
+    GameImpl::LevelPointers getLevelPointers() const noexcept;
+    std::array<const Map<std::uint32_t>*, ItemCount> getItemProbPtrs() const noexcept;
+
+    GameImpl createGameImpl(Randomizer* const* randomizers) const;
+
+    const std::uint32_t* getInitialObjectMemory() const noexcept {
+        return m_initialObjectMemory.data();
+    }
+
+    const std::uint32_t* getObjectPairIndices() const noexcept {
+        return m_objectPairIndices.data();
+    }
+
+    const std::uint32_t* getObjectParams() const noexcept {
+        return m_objectParams.data();
+    }
+
+    const sf::Vector2u& getMapSize() const noexcept {
+        return m_mapSize;
+    }
+
+    unsigned int getDifficulty() const noexcept {
+        return m_diffIndex;
+    }
+
+    unsigned int getLevelIndex() const noexcept {
+        return m_levelIndex;
+    }
+
+    const GameData* getGameData() const noexcept {
+        return m_data;
+    }
+
+private:
+
+    const GameData* m_data = nullptr;
+    std::array<Map<std::uint32_t>, ItemCount> m_itemProbabilities;
+    AliasTable m_snakePositionTable;
+    SpecializedBehaviours m_specializedBehaviours;
+    std::vector<std::uint32_t> m_objectPairIndices;
+    std::vector<std::uint32_t> m_objectParams;
+    std::vector<std::uint32_t> m_initialObjectMemory;
+    sf::Vector2u m_mapSize;
+    unsigned int m_diffIndex = 0;
+    unsigned int m_levelIndex = 0;
+};
+
+} // namespace CrazySnakes
+
+#endif // !GAME_DATA_HPP
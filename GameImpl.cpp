@@ -28,38 +28,23 @@
 #include "ObjectEnums.hpp"
 #include "EventEnums.hpp"
 #include "ObjectBehaviour.hpp"
+#include "ObjectTransitions.hpp"
+#include "SpecializedBehaviours.hpp"
+#include "BehaviourProfiler.hpp"
+#include "AliasTable.hpp"
 #include "ObjParamEnumUtility.hpp"
 #include "FenwickTree.hpp"
 #include "Randomizer.hpp"
+#include <algorithm>
 #include <cassert>
 
-namespace {
-template<class Vec>
-sf::Vector2i getRandomPosition(const Vec& probMap,
-                               const sf::Vector2u& mapSize,
-                               CrazySnakes::Randomizer& randomizer) {
-    using fwt = CrazySnakes::FenwickTree<typename Vec::iterator,
-        typename Vec::const_iterator, std::ptrdiff_t, std::uintmax_t>;
-
-    std::uintmax_t modulo = fwt::getSum(probMap.begin(), probMap.size() - 1);
-    if (!modulo) return sf::Vector2i(mapSize);
-
-    std::uintmax_t random = randomizer.get(0, modulo - 1);
-    std::size_t target = fwt::rankQuery(probMap.begin(), probMap.end(), random);
-
-    sf::Vector2i result;
-    result.x = int(target % (std::size_t)mapSize.x);
-    result.y = int(target / (std::size_t)mapSize.x);
-    return result;
-}
-}
-
 namespace CrazySnakes {
 
 GameImpl::GameImpl(GameImpl&& src) noexcept :
     m_acceleration(src.m_acceleration),
     m_aimedTailSize(src.m_aimedTailSize),
     m_bonusCountToPowerup(src.m_bonusCountToPowerup),
+    m_deathCause(src.m_deathCause),
     m_effect(src.m_effect),
     m_fruitCountToBonus(src.m_fruitCountToBonus),
     m_harmlessLessStepID(src.m_harmlessLessStepID),
@@ -85,6 +70,7 @@ GameImpl& GameImpl::operator=(GameImpl&& src) noexcept {
     m_acceleration = src.m_acceleration;
     m_aimedTailSize = src.m_aimedTailSize;
     m_bonusCountToPowerup = src.m_bonusCountToPowerup;
+    m_deathCause = src.m_deathCause;
     m_effect = src.m_effect;
     m_fruitCountToBonus = src.m_fruitCountToBonus;
     m_harmlessLessStepID = src.m_harmlessLessStepID;
@@ -134,38 +120,40 @@ void GameImpl::reset(const LevelPointers& ptrs,
     assert(ptrs.postEffectBehIndices);
     assert(ptrs.powerupProbs);
     assert(ptrs.preEffectBehIndices);
-    assert(ptrs.snakePositionProbs);
+    assert(ptrs.snakePositionTable);
     assert(ptrs.tailCapacities1);
 
     m_levelPtrs = ptrs;
+    m_snakeWorld.reset(m_intiItemProbs.data());
+    m_objectMemory.reset(m_snakeWorld.getMapSize(), objectMemory);
     restart(objectMemory);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void GameImpl::restart(const std::uint32_t* objectMemory) {
-    sf::Vector2i snakePos =
-        getRandomPosition(*m_levelPtrs.snakePositionProbs,
-                          m_intiItemProbs.front()->getSize(),
-                          useRandomizer(RandomizerType::Position));
+    const sf::Vector2u& mapSize = m_intiItemProbs.front()->getSize();
+    sf::Vector2i snakePos(mapSize);
 
-    m_snakeWorld.restart(m_intiItemProbs.data(), snakePos);
+    if (!m_levelPtrs.snakePositionTable->empty()) {
+        std::size_t cell = m_levelPtrs.snakePositionTable->draw(useRandomizer(RandomizerType::Position));
+        snakePos.x = int(cell % mapSize.x);
+        snakePos.y = int(cell / mapSize.x);
+    }
 
-    for (std::uint32_t i = 0; i < getLevelAttribute(LevelAttribEnum::FruitCount); ++i)
-        m_snakeWorld.placeFruit(*m_randomizers[(std::size_t)RandomizerType::Position]);
+    m_snakeWorld.restart(snakePos);
+    m_snakeWorld.placeFruits(getLevelAttribute(LevelAttribEnum::FruitCount),
+                             useRandomizer(RandomizerType::Position));
 
-    if (objectMemory) {
-        m_objectMemory.assign(objectMemory, objectMemory + (std::size_t)getSnakeWorld().getMapSize().x *
-                              getSnakeWorld().getMapSize().y);
-    } else {
-        m_objectMemory.clear();
-        m_objectMemory.resize((std::size_t)getSnakeWorld().getMapSize().x *
-                              getSnakeWorld().getMapSize().y);
-    }
+    if (objectMemory == m_objectMemory.getInitialData())
+        m_objectMemory.restore();
+    else
+        m_objectMemory.reset(getSnakeWorld().getMapSize(), objectMemory);
 
     // reset some states
     m_snakeDirection = Direction::Count;
     m_harmlessLessStepID = 0;
     m_snakeIsAlive = true;
+    m_deathCause = DeathCause::NoDeath;
     m_snakeIsMoving = false;
     m_acceleration = Acceleration::Default;
     m_effect = EffectTypeAl::NoEffect;
@@ -175,6 +163,56 @@ void GameImpl::restart(const std::uint32_t* objectMemory) {
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void GameImpl::setRandomizers(Randomizer* const* randomizers) noexcept {
+    std::copy(randomizers, randomizers + RandomTypeCount, m_randomizers.begin());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void GameImpl::takeSnapshot(Snapshot& snapshot) {
+    m_snakeWorld.takeSnapshot(snapshot.m_world);
+    m_objectMemory.setUndoLogged(true);
+
+    snapshot.m_objectMemoryMark = m_objectMemory.getUndoMark();
+    snapshot.m_aimedTailSize = m_aimedTailSize;
+    snapshot.m_harmlessLessStepID = m_harmlessLessStepID;
+    snapshot.m_snakeDirection = m_snakeDirection;
+    snapshot.m_acceleration = m_acceleration;
+    snapshot.m_effect = m_effect;
+    snapshot.m_deathCause = m_deathCause;
+    snapshot.m_fruitCountToBonus = m_fruitCountToBonus;
+    snapshot.m_bonusCountToPowerup = m_bonusCountToPowerup;
+    snapshot.m_snakeIsMoving = m_snakeIsMoving;
+    snapshot.m_snakeIsAlive = m_snakeIsAlive;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void GameImpl::restoreSnapshot(const Snapshot& snapshot) {
+    m_snakeWorld.restoreSnapshot(snapshot.m_world);
+    m_objectMemory.undo(snapshot.m_objectMemoryMark);
+
+    m_aimedTailSize = snapshot.m_aimedTailSize;
+    m_harmlessLessStepID = snapshot.m_harmlessLessStepID;
+    m_snakeDirection = snapshot.m_snakeDirection;
+    m_acceleration = snapshot.m_acceleration;
+    m_effect = snapshot.m_effect;
+    m_deathCause = snapshot.m_deathCause;
+    m_fruitCountToBonus = snapshot.m_fruitCountToBonus;
+    m_bonusCountToPowerup = snapshot.m_bonusCountToPowerup;
+    m_snakeIsMoving = snapshot.m_snakeIsMoving;
+    m_snakeIsAlive = snapshot.m_snakeIsAlive;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void GameImpl::dropSnapshots() {
+    m_snakeWorld.dropSnapshots();
+    m_objectMemory.setUndoLogged(false);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 std::uintmax_t GameImpl::move() {
     std::uintmax_t gameEvents = 0;
@@ -194,18 +232,7 @@ std::uintmax_t GameImpl::move() {
 
     // deleting mode
 
-    int backDeletingMode;
-
-    if (m_aimedTailSize > m_snakeWorld.getTailSize()) {
-        // increase the tail size by moving the head
-        backDeletingMode = 0;
-    } else if (m_aimedTailSize == m_snakeWorld.getTailSize()) {
-        // don't change the tail size (compensate)
-        backDeletingMode = 1;
-    } else {
-        // decrease the tail size (1 to compensate and 1 to erase)
-        backDeletingMode = 2;
-    }
+    int backDeletingMode = getBackDeletingMode();
 
     // possibly eaten powerup
 
@@ -316,15 +343,11 @@ std::uintmax_t GameImpl::move() {
 
     if (!notNeedToTestTail) {
         unsigned int width = m_intiItemProbs.front()->getSize().x;
-        const auto& tailId = m_snakeWorld.getTailIDs(currentSnakePosition);
-
-        std::size_t tailElementFound = tailId.size();
-
         // without harmless'es
-        std::size_t harmfullElementFound = tailElementFound;
-        for (auto now = tailId.begin(); now != tailId.end(); ++now) {
-            if (now->first < m_harmlessLessStepID) --harmfullElementFound;
-            else break;
+        std::size_t harmfullElementFound = 0;
+        for (const auto& now : m_snakeWorld.getTailIDs(currentSnakePosition)) {
+            if (now.first >= m_harmlessLessStepID)
+                ++harmfullElementFound;
         }
 
         std::size_t freedom =
@@ -337,6 +360,7 @@ std::uintmax_t GameImpl::move() {
 
         if (!ordinaryReason && !effectReason) {
             m_snakeIsAlive = false; // kill Snake by tail
+            m_deathCause = DeathCause::Tail;
             gameEvents |= (MAX_ONE << (int)GameSubevent::Killed);
         }
     }
@@ -371,20 +395,110 @@ std::uintmax_t GameImpl::move() {
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::uintmax_t GameImpl::getQuietStepCount(std::uintmax_t limit) const noexcept {
+    if (!m_snakeIsAlive || !m_snakeIsMoving || !m_levelPtrs.objectTransitions ||
+        m_snakeDirection == Direction::Count)
+        return 0;
+
+    Direction previousDirection = m_snakeWorld.getPreviousDirection();
+    if (previousDirection != Direction::Count && m_snakeDirection == oppositeDirection(previousDirection))
+        return 0;
+
+    // straight on, so no cell is reached twice before it turns around the map
+    sf::Vector2i mapSize(m_snakeWorld.getMapSize());
+    bool horizontal = (m_snakeDirection == Direction::Left || m_snakeDirection == Direction::Right);
+    limit = std::min(limit, (std::uintmax_t)(horizontal ? mapSize.x : mapSize.y) - 1);
+
+    sf::Vector2i position = m_snakeWorld.getCurrentSnakePosition();
+    std::uintmax_t stepCount = 0;
+
+    for (; stepCount < limit; ++stepCount) {
+        if (!isObjectQuiet(ObjectEffect::Pre, position, previousDirection))
+            break;
+
+        sf::Vector2i next = position;
+        moveOnModulus(next, m_snakeDirection, mapSize);
+
+        if (m_snakeWorld.getItem(next) != EatableItem::Count ||
+            !m_snakeWorld.getTailIDs(next).empty() ||
+            !isObjectQuiet(ObjectEffect::Post, next, m_snakeDirection))
+            break;
+
+        position = next;
+        previousDirection = m_snakeDirection;
+    }
+
+    return stepCount;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::uintmax_t GameImpl::moveQuietly() {
+    int backDeletingMode = getBackDeletingMode();
+
+    m_snakeWorld.moveSnake(m_snakeDirection);
+
+    for (int i = 0; i < backDeletingMode; ++i)
+        m_snakeWorld.trimTail();
+
+    // move() draws it every step
+    (void)getRandomPowerup();
+
+    const sf::Vector2i& position = m_snakeWorld.getCurrentSnakePosition();
+    return (std::uintmax_t)getObjectMemory(position.x, position.y) << 32;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+int GameImpl::getBackDeletingMode() const noexcept {
+    if (m_aimedTailSize > m_snakeWorld.getTailSize()) {
+        // increase the tail size by moving the head
+        return 0;
+    } else if (m_aimedTailSize == m_snakeWorld.getTailSize()) {
+        // don't change the tail size (compensate)
+        return 1;
+    }
+
+    // decrease the tail size (1 to compensate and 1 to erase)
+    return 2;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool GameImpl::isObjectQuiet(ObjectEffect effect, const sf::Vector2i& position,
+                             Direction previousDirection) const noexcept {
+    std::size_t cellIndex = position.x + (std::size_t)position.y * m_snakeWorld.getMapSize().x;
+    const std::uint32_t* behIndices = (effect == ObjectEffect::Pre ? m_levelPtrs.preEffectBehIndices :
+                                       m_levelPtrs.postEffectBehIndices);
+    std::uint32_t remembered = m_objectMemory.get(position.x, position.y);
+
+    ObjectTransitions::Outcome outcome;
+    if (m_levelPtrs.objectTransitions->find(behIndices[m_levelPtrs.objectPairIndices[cellIndex]],
+                                            m_levelPtrs.objectParams[cellIndex], remembered,
+                                            previousDirection, m_snakeDirection, m_acceleration,
+                                            outcome) != ObjectTransitions::Lookup::Known)
+        return false;
+
+    return outcome.snakeDirection == m_snakeDirection && outcome.snakeAcceleration == m_acceleration &&
+        outcome.remembered == remembered && !outcome.kills && !outcome.stops;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void GameImpl::objectEffect(ObjectEffect effect) {
     // To start with
     sf::Vector2i currSnakePos = m_snakeWorld.getCurrentSnakePosition();
     bool preEffect = (effect == ObjectEffect::Pre);
 
-    std::uint32_t param = m_levelPtrs.objectParams[currSnakePos.x +
-        currSnakePos.y * m_intiItemProbs.front()->getSize().x];
+    std::int64_t cellIndex = currSnakePos.x + (std::int64_t)currSnakePos.y * m_intiItemProbs.front()->getSize().x;
+    std::uint32_t param = m_levelPtrs.objectParams[cellIndex];
+
+    const std::uint32_t* behIndices = (preEffect ? m_levelPtrs.preEffectBehIndices : m_levelPtrs.postEffectBehIndices);
+    std::uint32_t behaviourIndex = behIndices[m_levelPtrs.objectPairIndices[cellIndex]];
 
-    // Fill arguments
-    ObjectBehaviour::ExecutionArguments arguments;
-    arguments.parameter = param;
-    arguments.previousSnakeDirection = m_snakeWorld.getPreviousDirection();
-    arguments.randomizer = &useRandomizer(RandomizerType::Behaviour);
+    if constexpr (BehaviourProfiler::Enabled)
+        BehaviourProfiler::beginEffect(m_levelPtrs.objectPairIndices[cellIndex], effect, behaviourIndex);
 
     // Fill target
     ObjectBehaviour::ExecutionTarget target{};
@@ -396,24 +510,46 @@ void GameImpl::objectEffect(ObjectEffect effect) {
 
     // Activate!
 
-    {
-        std::int64_t tmp1 = currSnakePos.x + (std::int64_t)currSnakePos.y * m_intiItemProbs.front()->getSize().x;
-        std::uint32_t tmp2 = m_levelPtrs.objectPairIndices[tmp1];
-        const std::uint32_t* tmp3 = (preEffect ? m_levelPtrs.preEffectBehIndices : m_levelPtrs.postEffectBehIndices);
-        std::uint32_t tmp4 = tmp3[tmp2];
-        const ObjectBehaviour& currentBehaviour = m_levelPtrs.objectBehs[tmp4];
+    // The programs never read the alive and moving states, only clear them,
+    // so the tabulated outcome holds for any; the rest (random ones etc.) is run
+    ObjectTransitions::Outcome outcome;
+    if (m_levelPtrs.objectTransitions &&
+        m_levelPtrs.objectTransitions->find(behaviourIndex, param, target.remembered,
+                                            m_snakeWorld.getPreviousDirection(), m_snakeDirection,
+                                            m_acceleration, outcome) == ObjectTransitions::Lookup::Known) {
+        target.remembered = outcome.remembered;
+        target.alive = target.alive && !outcome.kills;
+        target.moving = target.moving && !outcome.stops;
+        target.snakeAcceleration = outcome.snakeAcceleration;
+        target.snakeDirection = outcome.snakeDirection;
+    } else {
+        // Fill arguments
+        ObjectBehaviour::ExecutionArguments arguments;
+        arguments.parameter = param;
+        arguments.previousSnakeDirection = m_snakeWorld.getPreviousDirection();
+        arguments.randomizer = &useRandomizer(RandomizerType::Behaviour);
+
+        const ObjectBehaviour& behaviour = (m_levelPtrs.specializedBehs ?
+            m_levelPtrs.specializedBehs->get(behaviourIndex, param) : m_levelPtrs.objectBehs[behaviourIndex]);
+
+        if constexpr (BehaviourProfiler::Enabled)
+            BehaviourProfiler::beginRun();
+
+        behaviour.activate(target, arguments);
 
-        currentBehaviour.activate(target, arguments);
+        if constexpr (BehaviourProfiler::Enabled)
+            BehaviourProfiler::endRun();
     }
 
     // Save from target
     m_snakeDirection = target.snakeDirection;
     m_acceleration = target.snakeAcceleration;
     m_snakeIsMoving = target.moving;
+    if (target.alive != m_snakeIsAlive)
+        m_deathCause = (target.alive ? DeathCause::NoDeath : DeathCause::Object);
     m_snakeIsAlive = target.alive;
 
-    m_objectMemory[(std::size_t)currSnakePos.x +
-        (std::size_t)currSnakePos.y * getSnakeWorld().getMapSize().x] = target.remembered;
+    m_objectMemory.set(currSnakePos.x, currSnakePos.y, target.remembered);
 }
 
 
@@ -502,7 +638,7 @@ PowerupType GameImpl::getRandomPowerup() const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 std::uint32_t GameImpl::getObjectMemory(int x, int y) const {
-    return m_objectMemory[(std::size_t)x + (std::size_t)y * getSnakeWorld().getMapSize().x];
+    return m_objectMemory.get(x, y);
 }
 
 
@@ -526,13 +662,13 @@ void GameImpl::finishEffect() noexcept {
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void GameImpl::removeBonus() noexcept {
+void GameImpl::removeBonus() {
     m_snakeWorld.clearBonuses();
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void GameImpl::removePowerup() noexcept {
+void GameImpl::removePowerup() {
     m_snakeWorld.clearPowerups();
 }
 
@@ -26,6 +26,7 @@
 #ifndef GAME_IMPL_HPP
 #define GAME_IMPL_HPP
 #include "SnakeWorld.hpp"
+#include "PagedGrid.hpp"
 #include "MiscEnum.hpp"
 
 /// Note that Snake has the factual direction when the snake
@@ -58,6 +59,9 @@ enum class LevelAttribEnum;
 class Randomizer;
 enum class ObjectEffect;
 class ObjectBehaviour;
+class ObjectTransitions;
+class SpecializedBehaviours;
+class AliasTable;
 
 class GameImpl {
 
@@ -67,7 +71,9 @@ public:
         // single
 
         const std::array<std::uintmax_t, fwkGetRealSize<std::size_t, int>(PowerupCount)>* powerupProbs = nullptr;
-        const std::vector<std::uintmax_t>* snakePositionProbs = nullptr;
+        const AliasTable* snakePositionTable = nullptr; // by the cell index
+        const ObjectTransitions* objectTransitions = nullptr; // of objectBehs
+        const SpecializedBehaviours* specializedBehs = nullptr; // of objectBehs for the map, optional
 
         // arrays
 
@@ -82,6 +88,26 @@ public:
         const std::uint32_t* attribArray = nullptr;
     };
 
+    // The game state to come back to (see takeSnapshot)
+    class Snapshot {
+    private:
+
+        friend class GameImpl;
+
+        SnakeWorld::Snapshot m_world;
+        std::size_t m_objectMemoryMark = 0;
+        std::uintmax_t m_aimedTailSize = 0;
+        std::uintmax_t m_harmlessLessStepID = 0;
+        Direction m_snakeDirection{};
+        Acceleration m_acceleration{};
+        EffectTypeAl m_effect{};
+        DeathCause m_deathCause{};
+        unsigned int m_fruitCountToBonus = 0;
+        unsigned int m_bonusCountToPowerup = 0;
+        bool m_snakeIsMoving = false;
+        bool m_snakeIsAlive = false;
+    };
+
     GameImpl(const GameImpl&) = default;
     GameImpl(GameImpl&&) noexcept;
 
@@ -104,20 +130,42 @@ public:
 
            // Controlling
 
+    // objectMemory is a dependency like the level pointers (or nullptr for zeros).
+    // Only the cells changed since the last restart are restored.
     void restart(const std::uint32_t* objectMemory);
 
+    // Snapshots like the SnakeWorld ones: taking costs next to nothing,
+    // restoring costs as much as changed since then. The randomizers are not a part of them.
+    void takeSnapshot(Snapshot& snapshot);
+    void restoreSnapshot(const Snapshot& snapshot);
+    void dropSnapshots();
+
     /// Kill the snake and stop the game
-    void killSnake() noexcept {
+    void killSnake(DeathCause cause = DeathCause::Killed) noexcept {
+        if (m_snakeIsAlive)
+            m_deathCause = cause;
         m_snakeIsAlive = false;
     }
 
     void finishEffect() noexcept;
-    void removeBonus() noexcept;
-    void removePowerup() noexcept;
+    void removeBonus();
+    void removePowerup();
 
     std::uintmax_t move();
+
+    /// How many of the next steps (up to limit) are quiet: straight on through the cells
+    /// where the objects change nothing, with no items and no tail, before any command.
+    /// Such a step can go by moveQuietly, the same as by move but much cheaper.
+    std::uintmax_t getQuietStepCount(std::uintmax_t limit) const noexcept;
+
+    /// One quiet step (see getQuietStepCount), returns the subevents of move
+    std::uintmax_t moveQuietly();
+
     void pushCommand(Direction rotateCommand) noexcept;
 
+    // the same state on other randomizers (a copy gets the pointers of the original)
+    void setRandomizers(Randomizer* const* randomizers) noexcept;
+
     // Getters
 
     const Randomizer* getRandomizer(RandomizerType what) const noexcept;
@@ -127,6 +175,11 @@ public:
         return m_snakeIsAlive;
     }
 
+    /// NoDeath while Snake is alive
+    DeathCause getDeathCause() const noexcept {
+        return m_deathCause;
+    }
+
 /// The method returns true if Snake is moving, otherwise retuns false.
 /// The snake can be stopped by the stopper, but the player can move the snake back.
 /// Don't confuse with isSnakeAlive.
@@ -164,10 +217,20 @@ public:
 /// Check spikes on the position on the map.
     std::uint32_t getObjectMemory(int x, int y) const;
 
+    /// The object memory of all the cells, to read many at once
+    const PagedGrid<std::uint32_t>& getObjectMemoryGrid() const noexcept {
+        return m_objectMemory;
+    }
+
     const SnakeWorld& getSnakeWorld() const noexcept {
         return m_snakeWorld;
     }
 
+    /// The tail size Snake grows to (or cuts down to) by the steps
+    std::uintmax_t getAimedTailSize() const noexcept {
+        return m_aimedTailSize;
+    }
+
     std::uintmax_t getHarmlessLessStepID() const noexcept {
         return m_harmlessLessStepID;
     }
@@ -185,6 +248,13 @@ private:
 
     void objectEffect(ObjectEffect effect);
 
+    // How move trims the tail: 0 to grow, 1 to keep the size, 2 to cut it down
+    int getBackDeletingMode() const noexcept;
+
+    // the effect of the object on the position changes nothing (only known ones, see ObjectTransitions)
+    bool isObjectQuiet(ObjectEffect effect, const sf::Vector2i& position,
+                       Direction previousDirection) const noexcept;
+
     Randomizer& useRandomizer(RandomizerType what) const noexcept;
 
     ////////////////////////////////////////////////////////////
@@ -203,7 +273,7 @@ private:
     // main states
 
     // For detecting activated spikes
-    std::vector<std::uint32_t> m_objectMemory;
+    PagedGrid<std::uint32_t> m_objectMemory;
 
     std::uintmax_t m_aimedTailSize = 0;
 
@@ -219,6 +289,9 @@ private:
     // Current active Snake's effect
     EffectTypeAl m_effect = EffectTypeAl::NoEffect;
 
+    // Why Snake has died
+    DeathCause m_deathCause = DeathCause::NoDeath;
+
     // How many fruits Snake should eat to bonus acquiring
     unsigned int m_fruitCountToBonus = 0;
 
@@ -0,0 +1,547 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "LevelAnalyzer.hpp"
+#include "GameData.hpp"
+#include "Game.hpp"
+#include "Randomizer.hpp"
+#include "AttribEnums.hpp"
+#include "ObjParamEnumUtility.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using namespace CrazySnakes;
+
+// the bytes of a copy of the game per cell (the item probabilities, the object memory,
+// the items, the tail slots and their journals) if not paged
+constexpr std::size_t StateBytesPerCell = 32;
+constexpr std::size_t PagedStateBytes = (std::size_t)1 << 20;
+
+// merged states remembered over the steps
+constexpr std::size_t VisitedLimit = (std::size_t)1 << 22;
+
+// distance maps kept for the item sets seen
+constexpr std::size_t DistanceMapLimit = 256;
+
+// the distance doesn't get into the item progress in the score
+constexpr int MaxDistance = (1 << 20) - 1;
+
+// by Direction
+const sf::Vector2i DirectionOffsets[DirectionCount]{ { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+std::uint64_t mixHash(std::uint64_t hash, std::uint64_t value) noexcept {
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+std::uint64_t hashPosition(const sf::Vector2i& position) noexcept {
+    std::uint64_t z = ((std::uint64_t)(std::uint32_t)position.x << 32 | (std::uint32_t)position.y) +
+        0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+int getDistance(const sf::Vector2i& a, const sf::Vector2i& b, const sf::Vector2u& mapSize) noexcept {
+    int dx = std::abs(a.x - b.x);
+    int dy = std::abs(a.y - b.y);
+    return std::min(dx, (int)mapSize.x - dx) + std::min(dy, (int)mapSize.y - dy);
+}
+
+
+// Runs f(i) for i < count on the threads
+template<class F>
+void parallelFor(std::size_t count, unsigned int threadCount, F&& f) {
+    std::size_t workerCount = std::min<std::size_t>(threadCount, count);
+    if (workerCount <= 1) {
+        for (std::size_t i = 0; i < count; ++i)
+            f(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next{ 0 };
+    std::vector<std::exception_ptr> exceptions(workerCount);
+
+    auto work = [&](std::size_t worker) {
+        try {
+            for (std::size_t i = next++; i < count; i = next++)
+                f(i);
+        } catch (...) {
+            exceptions[worker] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+    try {
+        for (std::size_t i = 1; i < workerCount; ++i)
+            threads.emplace_back(work, i);
+    } catch (...) {
+        // the started ones do all the work, they must not be destroyed joinable
+        for (auto& thread : threads)
+            thread.join();
+        throw;
+    }
+
+    work(0);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& exception : exceptions) {
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+}
+
+
+// A state of the search: the game stopped right after a step
+struct Node {
+    Game game;
+    RandomizerSet randomizers;
+    std::int64_t time = 0;
+    std::uint32_t eatenCount = 0; // of the challenge items
+
+    void pointRandomizers() noexcept {
+        std::array<Randomizer*, RandomTypeCount> pointers = randomizers.getPointers();
+        game.setRandomizers(pointers.data());
+    }
+};
+
+
+// A direction tried from a node
+struct Candidate {
+    std::size_t parent = 0;
+    Direction direction = Direction::Count;
+    std::uint64_t hash = 0;
+    std::int64_t score = 0;
+    std::int64_t deathCell = -1; // killed by the object there
+    bool tried = false;
+    bool alive = false;
+    bool completed = false;
+};
+
+
+class WorldSearch {
+public:
+
+    WorldSearch(const LevelSetup& setup, const LevelAnalyzer::Options& options, std::size_t beamWidth) :
+        m_setup(&setup),
+        m_options(&options),
+        m_beamWidth(beamWidth) {
+        const GameData& data = *setup.getGameData();
+        const std::uint32_t* plot = data.getLevels().getLevelPlotDataPtr(setup.getDifficulty(),
+                                                                         setup.getLevelIndex());
+        m_challenge = (ChallengeType)plot[(int)LevelPlotDataEnum::Challenge];
+        m_challengeCount = plot[(int)LevelPlotDataEnum::ChallengeCount];
+    }
+
+    // the steps of the shortest solution found or 0
+    std::uintmax_t run(std::uint64_t seed, unsigned int threadCount);
+
+    std::uintmax_t getStateCount() const noexcept {
+        return m_stateCount;
+    }
+
+    bool isExhaustive() const noexcept {
+        return m_exhaustive;
+    }
+
+private:
+
+    // one step of the node in the direction, false if the snake has died or can't move
+    bool step(Node& node, Direction direction) const;
+
+    void evaluate(const Node& node, Candidate& candidate);
+
+    // Steps to the nearest target around the cells the snake has been killed at by the objects,
+    // the toroidal distance if paged. Shared by the workers.
+    std::shared_ptr<const std::vector<int>> getDistanceMap(std::uint64_t targetHash,
+                                                           const std::vector<sf::Vector2i>& targets);
+
+    const LevelSetup* m_setup;
+    const LevelAnalyzer::Options* m_options;
+    std::size_t m_beamWidth;
+    ChallengeType m_challenge = ChallengeType::Fruits;
+    std::uint32_t m_challengeCount = 0;
+    std::uintmax_t m_stateCount = 0;
+    std::vector<std::uint8_t> m_blocked; // by the cell, not paged only
+    std::unordered_map<std::uint64_t, std::shared_ptr<const std::vector<int>>> m_distanceMaps;
+    std::mutex m_distanceMutex;
+    bool m_exhaustive = true;
+};
+
+
+bool WorldSearch::step(Node& node, Direction direction) const {
+    Game& game = node.game;
+
+    // the command goes right after the previous step
+    game.pushCommand(node.time, direction);
+    game.update(node.time);
+
+    std::int64_t timeToMove = game.getEventProcessor().getTimeToEvent((std::size_t)MainGameEvent::Moved);
+    if (!game.getImpl().isSnakeAlive() || timeToMove <= 0)
+        return false;
+
+    node.time += timeToMove;
+    game.update(node.time);
+
+    static_assert((int)GameSubevent::BonusEaten - (int)GameSubevent::FruitEaten == (int)ChallengeType::Bonuses &&
+                  (int)GameSubevent::PowerupEaten - (int)GameSubevent::FruitEaten == (int)ChallengeType::Powerups);
+
+    auto challengeEvent = (GameSubevent)((int)GameSubevent::FruitEaten + (int)m_challenge);
+
+    Game::Event event;
+    while (game.pollEvent(event)) {
+        if (!event.isMain && event.subevent == challengeEvent)
+            ++node.eatenCount;
+    }
+
+    return game.getImpl().isSnakeAlive();
+}
+
+
+void WorldSearch::evaluate(const Node& node, Candidate& candidate) {
+    const GameImpl& impl = node.game.getImpl();
+    const SnakeWorld& world = impl.getSnakeWorld();
+    const sf::Vector2i& head = world.getCurrentSnakePosition();
+
+    // the whole state but the step count (the timers are relative), so the merged states have the same future
+    std::uint64_t hash = hashPosition(head);
+    hash = mixHash(hash, hashPosition(world.getBackPosition()));
+    hash = mixHash(hash, world.getTailSize());
+    hash = mixHash(hash, (std::uint64_t)world.getPreviousDirection());
+    hash = mixHash(hash, (std::uint64_t)impl.getSnakeDirection());
+    hash = mixHash(hash, (std::uint64_t)impl.getSnakeAcceleration());
+    hash = mixHash(hash, (std::uint64_t)impl.getEffect());
+    hash = mixHash(hash, impl.isSnakeMoving());
+    hash = mixHash(hash, impl.getFruitCountToBonus());
+    hash = mixHash(hash, impl.getBonusCountToPowerup());
+    hash = mixHash(hash, impl.getAimedTailSize());
+    hash = mixHash(hash, world.getStepCount() - impl.getHarmlessLessStepID());
+    hash = mixHash(hash, node.eatenCount);
+
+    const Game::GameEventProcessor& events = node.game.getEventProcessor();
+    for (std::size_t i = 0; i < events.getEventCount(); ++i)
+        hash = mixHash(hash, (std::uint64_t)events.getTimeToEvent(i));
+
+    for (int i = 0; i < RandomTypeCount; ++i) {
+        for (std::uint64_t word : impl.getRandomizer((RandomizerType)i)->getState())
+            hash = mixHash(hash, word);
+    }
+
+    // the cells have no order either
+    const PagedGrid<std::uint32_t>& objectMemory = impl.getObjectMemoryGrid();
+    std::uint64_t memory = 0;
+    objectMemory.forEachChanged([&objectMemory, &memory](int x, int y) {
+        std::uint32_t value = objectMemory.get(x, y);
+        if (value != objectMemory.getInitial(x, y))
+            memory += mixHash(hashPosition(sf::Vector2i(x, y)), value);
+    });
+    hash = mixHash(hash, memory);
+
+    world.forEachTailSegment([&hash](const SnakeWorld::TailSegment& segment) {
+        hash = mixHash(hash, (std::uint64_t)segment.id.second.tdexit);
+    });
+
+    // the sets have no order
+    std::uint64_t items = 0;
+    for (const auto& position : world.getFruitPositions())
+        items += hashPosition(position);
+    for (const auto& position : world.getBonusPositions())
+        items += hashPosition(position) * 3;
+    for (const auto& powerup : world.getPowerups())
+        items += hashPosition(powerup.first) * 5 + (std::uint64_t)powerup.second;
+    hash = mixHash(hash, items);
+
+    // the nearest item that leads to the challenge
+    const sf::Vector2u& mapSize = world.getMapSize();
+    std::vector<sf::Vector2i> targets;
+
+    if (m_challenge == ChallengeType::Powerups && !world.getPowerups().empty()) {
+        for (const auto& powerup : world.getPowerups())
+            targets.push_back(powerup.first);
+    } else if (m_challenge != ChallengeType::Fruits && !world.getBonusPositions().empty()) {
+        targets.assign(world.getBonusPositions().begin(), world.getBonusPositions().end());
+    } else {
+        targets.assign(world.getFruitPositions().begin(), world.getFruitPositions().end());
+    }
+
+    int distance = MaxDistance;
+    if (m_blocked.empty()) {
+        for (const auto& target : targets)
+            distance = std::min(distance, getDistance(head, target, mapSize));
+    } else if (!targets.empty()) {
+        std::uint64_t targetHash = 0;
+        for (const auto& target : targets)
+            targetHash += hashPosition(target);
+
+        distance = (*getDistanceMap(targetHash, targets))[head.x + (std::size_t)head.y * mapSize.x];
+    }
+
+    // the challenge items, then the ones leading to them, then the distance
+    std::int64_t score = (std::int64_t)node.eatenCount << 40;
+    if (m_challenge != ChallengeType::Fruits)
+        score -= (std::int64_t)impl.getFruitCountToBonus() << 20;
+    if (m_challenge == ChallengeType::Powerups)
+        score -= (std::int64_t)impl.getBonusCountToPowerup() << 30;
+    score -= distance;
+
+    candidate.hash = hash;
+    candidate.score = score;
+}
+
+
+std::shared_ptr<const std::vector<int>>
+WorldSearch::getDistanceMap(std::uint64_t targetHash, const std::vector<sf::Vector2i>& targets) {
+    {
+        std::lock_guard<std::mutex> lock(m_distanceMutex);
+        auto found = m_distanceMaps.find(targetHash);
+        if (found != m_distanceMaps.end())
+            return found->second;
+    }
+
+    // breadth-first from the targets over the torus
+    const sf::Vector2u& mapSize = m_setup->getMapSize();
+    auto distances = std::make_shared<std::vector<int>>(m_blocked.size(), MaxDistance);
+    std::vector<sf::Vector2i> queue(targets.begin(), targets.end());
+
+    for (const auto& target : targets)
+        (*distances)[target.x + (std::size_t)target.y * mapSize.x] = 0;
+
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+        sf::Vector2i cell = queue[i];
+        int distance = (*distances)[cell.x + (std::size_t)cell.y * mapSize.x] + 1;
+
+        for (int d = 0; d < DirectionCount; ++d) {
+            sf::Vector2i next = cell + DirectionOffsets[d];
+            next.x = (next.x + (int)mapSize.x) % (int)mapSize.x;
+            next.y = (next.y + (int)mapSize.y) % (int)mapSize.y;
+
+            std::size_t index = next.x + (std::size_t)next.y * mapSize.x;
+            if (m_blocked[index] || (*distances)[index] <= distance)
+                continue;
+
+            (*distances)[index] = distance;
+            queue.push_back(next);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_distanceMutex);
+    if (m_distanceMaps.size() >= DistanceMapLimit)
+        m_distanceMaps.clear();
+    m_distanceMaps.emplace(targetHash, distances);
+    return distances;
+}
+
+
+std::uintmax_t WorldSearch::run(std::uint64_t seed, unsigned int threadCount) {
+    if (!m_challengeCount)
+        return 0;
+
+    std::vector<std::unique_ptr<Node>> beam;
+    beam.push_back(std::make_unique<Node>());
+    {
+        Node& root = *beam.front();
+        root.randomizers.setSeed(seed);
+
+        std::array<Randomizer*, RandomTypeCount> randomizers = root.randomizers.getPointers();
+        root.game.restart(m_setup->createGameImpl(randomizers.data()));
+        root.game.setMainEventMask(0); // only the challenge items are counted
+    }
+
+    const sf::Vector2u& mapSize = m_setup->getMapSize();
+    if ((std::size_t)mapSize.x * mapSize.y < TriggerMapSize)
+        m_blocked.assign((std::size_t)mapSize.x * mapSize.y, 0);
+
+    std::unordered_set<std::uint64_t> visited;
+    std::vector<Candidate> candidates;
+    std::vector<Game::Snapshot> snapshots(beam.size());
+
+    for (std::uintmax_t stepCount = 1; stepCount <= m_options->stepLimit && !beam.empty(); ++stepCount) {
+        // every direction of every node, tried on its snapshot
+        candidates.assign(beam.size() * DirectionCount, Candidate{});
+        snapshots.resize(beam.size());
+
+        parallelFor(beam.size(), threadCount, [&](std::size_t i) {
+            Node& node = *beam[i];
+            Direction previous = node.game.getImpl().getSnakeWorld().getPreviousDirection();
+
+            node.game.takeSnapshot(snapshots[i]);
+            RandomizerSet randomizers = node.randomizers;
+            std::int64_t time = node.time;
+            std::uint32_t eatenCount = node.eatenCount;
+
+            for (int d = 0; d < DirectionCount; ++d) {
+                Candidate& candidate = candidates[i * DirectionCount + d];
+                candidate.parent = i;
+                candidate.direction = (Direction)d;
+
+                // ignored by the snake, the same as going on
+                if (previous != Direction::Count && candidate.direction == oppositeDirection(previous))
+                    continue;
+
+                candidate.tried = true;
+                candidate.alive = step(node, candidate.direction);
+                candidate.completed = (node.eatenCount >= m_challengeCount);
+                if (candidate.alive) {
+                    evaluate(node, candidate);
+                } else if (node.game.getImpl().getDeathCause() == DeathCause::Object) {
+                    const sf::Vector2i& head = node.game.getImpl().getSnakeWorld().getCurrentSnakePosition();
+                    candidate.deathCell = head.x + (std::int64_t)head.y * mapSize.x;
+                }
+
+                node.game.restoreSnapshot(snapshots[i]);
+                node.randomizers = randomizers;
+                node.time = time;
+                node.eatenCount = eatenCount;
+            }
+
+            node.game.dropSnapshots();
+        });
+
+        m_stateCount += std::count_if(candidates.begin(), candidates.end(),
+                                      [](const Candidate& candidate) { return candidate.tried; });
+
+        if (std::any_of(candidates.begin(), candidates.end(),
+                        [](const Candidate& candidate) { return candidate.completed; }))
+            return stepCount;
+
+        // the distances go around the deadly cells from now on
+        if (!m_blocked.empty()) {
+            bool blockedMore = false;
+            for (const auto& candidate : candidates) {
+                if (candidate.deathCell >= 0 && !m_blocked[(std::size_t)candidate.deathCell]) {
+                    m_blocked[(std::size_t)candidate.deathCell] = 1;
+                    blockedMore = true;
+                }
+            }
+            if (blockedMore)
+                m_distanceMaps.clear();
+        }
+
+        // the alive ones not seen yet, the best of the equal ones
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                        [](const Candidate& candidate) { return !candidate.alive; }),
+                         candidates.end());
+
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.hash != b.hash ? a.hash < b.hash : a.score > b.score;
+        });
+        candidates.erase(std::unique(candidates.begin(), candidates.end(),
+                                     [](const Candidate& a, const Candidate& b) { return a.hash == b.hash; }),
+                         candidates.end());
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                        [&visited](const Candidate& candidate) {
+                                            return visited.count(candidate.hash) != 0;
+                                        }),
+                         candidates.end());
+
+        if (candidates.size() > m_beamWidth) {
+            m_exhaustive = false;
+            std::nth_element(candidates.begin(), candidates.begin() + m_beamWidth, candidates.end(),
+                             [](const Candidate& a, const Candidate& b) {
+                                 return a.score != b.score ? a.score > b.score : a.hash < b.hash;
+                             });
+            candidates.resize(m_beamWidth);
+        }
+
+        if (visited.size() + candidates.size() <= VisitedLimit) {
+            for (const auto& candidate : candidates)
+                visited.insert(candidate.hash);
+        }
+
+        // the chosen ones are copied and stepped again
+        std::vector<std::unique_ptr<Node>> nextBeam(candidates.size());
+
+        parallelFor(candidates.size(), threadCount, [&](std::size_t i) {
+            const Candidate& candidate = candidates[i];
+            nextBeam[i] = std::make_unique<Node>(*beam[candidate.parent]);
+            nextBeam[i]->pointRandomizers();
+            step(*nextBeam[i], candidate.direction);
+        });
+
+        beam.swap(nextBeam);
+    }
+
+    return 0;
+}
+
+}
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+LevelAnalyzer::Result LevelAnalyzer::analyze(unsigned int difficulty, unsigned int levelIndex,
+                                             const Options& options) const {
+    unsigned int threadCount = options.threadCount;
+    if (!threadCount)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    LevelSetup setup;
+    setup.create(*m_data, difficulty, levelIndex);
+
+    const sf::Vector2u& mapSize = setup.getMapSize();
+    std::size_t area = (std::size_t)mapSize.x * mapSize.y;
+    std::size_t stateBytes = (area >= TriggerMapSize ? PagedStateBytes : area * StateBytesPerCell);
+
+    // the beam and the next one are alive at once
+    Result result;
+    result.beamWidth = std::max<std::size_t>(1, std::min(options.beamWidth, options.memoryLimit / (stateBytes * 2)));
+    result.difficulty = difficulty;
+    result.levelIndex = levelIndex;
+    result.worldCount = options.worldCount;
+
+    const std::uint32_t* plot = m_data->getLevels().getLevelPlotDataPtr(difficulty, levelIndex);
+    result.challenge = (ChallengeType)plot[(int)LevelPlotDataEnum::Challenge];
+    result.challengeCount = plot[(int)LevelPlotDataEnum::ChallengeCount];
+
+    for (unsigned int world = 0; world < options.worldCount; ++world) {
+        WorldSearch search(setup, options, result.beamWidth);
+        std::uintmax_t stepCount = search.run(options.seed + world, threadCount);
+
+        result.stateCount += search.getStateCount();
+        result.exhaustive = result.exhaustive && search.isExhaustive();
+
+        if (stepCount || !result.challengeCount) {
+            ++result.solvedCount;
+            if (!result.minStepCount || stepCount < result.minStepCount)
+                result.minStepCount = stepCount;
+        }
+    }
+
+    return result;
+}
+
+} // namespace CrazySnakes
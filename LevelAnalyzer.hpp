@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef LEVEL_ANALYZER_HPP
+#define LEVEL_ANALYZER_HPP
+#include "MiscEnum.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+class GameData;
+
+/// Checks whether the challenge of a level can be done within its time limit.
+/// The game is searched from the restart step by step (breadth-first, a beam if too wide)
+/// on all the cores: every state tries every direction on a snapshot, the best ones
+/// (more items eaten, closer to the next one) are copied for the next step.
+/// The states equal by the snake, the items, the progress, the object memory, the timers
+/// and the randomizers are merged by their hash, so the memory is bounded by the beam width.
+/// The items appear randomly, so the level is searched in several worlds (randomizer seeds).
+class LevelAnalyzer {
+public:
+
+    struct Options {
+        unsigned int threadCount = 0;                 // 0 means all the cores
+        unsigned int worldCount = 4;                  // randomizer seeds tried
+        std::uint64_t seed = 0;
+        std::size_t beamWidth = 256;                  // states kept after a step
+        std::size_t memoryLimit = (std::size_t)1 << 30; // bytes of the states, narrows the beam on big maps
+        std::uintmax_t stepLimit = 100000;
+    };
+
+    struct Result {
+        unsigned int difficulty = 0;
+        unsigned int levelIndex = 0;
+        ChallengeType challenge = ChallengeType::Fruits;
+        std::uint32_t challengeCount = 0;
+        unsigned int worldCount = 0;
+        unsigned int solvedCount = 0;      // worlds where the challenge has been done
+        std::uintmax_t minStepCount = 0;   // the shortest solution found (0 if none), the minimum if exhaustive
+        std::uintmax_t stateCount = 0;     // states tried
+        std::size_t beamWidth = 0;         // after the memory limit
+        bool exhaustive = true;            // no state has been dropped by the beam
+    };
+
+    // data: a dependency
+    explicit LevelAnalyzer(const GameData& data) noexcept :
+        m_data(&data) {}
+
+    // the exceptions of the workers are thrown here
+    Result analyze(unsigned int difficulty, unsigned int levelIndex, const Options& options) const;
+
+private:
+
+    const GameData* m_data;
+};
+
+} // namespace CrazySnakes
+
+#endif // !LEVEL_ANALYZER_HPP
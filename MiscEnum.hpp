@@ -48,6 +48,19 @@ enum class ChallengeType {
 };
 
 constexpr int ChallengeCount = static_cast<int>(ChallengeType::Count);
+
+// Why Snake has died
+enum class DeathCause {
+	NoDeath,   // alive
+	Object,    // killed by the object on the map
+	Tail,      // bitten its tail
+	TimeLimit, // the time limit has exceeded
+	Killed,    // killed from the outside
+
+	Count
+};
+
+constexpr int DeathCauseCount = static_cast<int>(DeathCause::Count);
 }
 
 #endif // !MISC_ENUM_HPP
\ No newline at end of file
@@ -27,7 +27,8 @@
 #include "Randomizer.hpp"
 #include "ObjectParameterEnums.hpp"
 #include "ObjParamEnumUtility.hpp"
-#include <forward_list>
+#include "BehaviourProfiler.hpp"
+#include <algorithm>
 #include <cassert>
 
 namespace CrazySnakes {
@@ -36,16 +37,18 @@ namespace CrazySnakes {
 ObjectBehaviour::ObjectBehaviour() noexcept :
     m_properties(),
     m_parameterType(ObjectParameterType::NoParameter),
-    m_commands(),
-    m_conditionExpressions(),
-    m_modifyExpressions() {}
+    m_code(),
+    m_conditionPrograms(),
+    m_modifyPrograms(),
+    m_commands() {}
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ObjectBehaviour::ObjectBehaviour(ObjectBehaviour&& src) noexcept :
+    m_code(std::move(src.m_code)),
+    m_conditionPrograms(std::move(src.m_conditionPrograms)),
+    m_modifyPrograms(std::move(src.m_modifyPrograms)),
     m_commands(std::move(src.m_commands)),
-    m_conditionExpressions(std::move(src.m_conditionExpressions)),
-    m_modifyExpressions(std::move(src.m_modifyExpressions)),
     m_parameterType(src.m_parameterType),
     m_properties(std::move(src.m_properties)) {
     src.m_properties.reset();
@@ -58,9 +61,10 @@ ObjectBehaviour& ObjectBehaviour::operator=(ObjectBehaviour&& src) noexcept {
     if (this == &src)
         return *this;
 
+    m_code = std::move(src.m_code);
+    m_conditionPrograms = std::move(src.m_conditionPrograms);
+    m_modifyPrograms = std::move(src.m_modifyPrograms);
     m_commands = std::move(src.m_commands);
-    m_conditionExpressions = std::move(src.m_conditionExpressions);
-    m_modifyExpressions = std::move(src.m_modifyExpressions);
     m_parameterType = src.m_parameterType;
     m_properties = std::move(src.m_properties);
 
@@ -82,9 +86,14 @@ std::optional<std::string> ObjectBehaviour::compile(const CompileParameters& par
     bool impacts = false;
     bool dangerous = false;
 
+    std::vector<Instruction> code;
+    std::vector<Program> conditionPrograms(parameters.conditionCount);
+    std::vector<Program> modifyPrograms(parameters.conditionCount + 1);
+
     for (std::size_t i = 0; i < parameters.conditionCount; ++i) {
-        std::optional<std::string> log{ validateValueExpression(StackValueType::Integer,
-            parameters.condExpressions[i], parameters.condExpressionSizes[i], states) };
+        std::optional<std::string> log{ compileValueExpression(StackValueType::Integer,
+            parameters.condExpressions[i], parameters.condExpressionSizes[i], states,
+            code, conditionPrograms[i]) };
 
         if (log) return log;
     }
@@ -111,8 +120,9 @@ std::optional<std::string> ObjectBehaviour::compile(const CompileParameters& par
                 break;
             }
 
-            std::optional<std::string> log{ validateValueExpression(checkType,
-                parameters.modifyExpressions[i], parameters.modifyExpressionSizes[i], states) };
+            std::optional<std::string> log{ compileValueExpression(checkType,
+                parameters.modifyExpressions[i], parameters.modifyExpressionSizes[i], states,
+                code, modifyPrograms[i]) };
 
             if (log)
                 return log;
@@ -133,24 +143,12 @@ std::optional<std::string> ObjectBehaviour::compile(const CompileParameters& par
     m_parameterType = states.paramType;
 
     m_commands.assign(parameters.commands, parameters.commands + parameters.conditionCount + 1);
-    m_conditionExpressions.resize(parameters.conditionCount);
-    m_modifyExpressions.resize(parameters.conditionCount + 1);
-
-    for (std::size_t i = 0; i < parameters.conditionCount; ++i)
-        m_conditionExpressions[i].assign(parameters.condExpressions[i],
-                                         parameters.condExpressions[i] + 
-                                         parameters.condExpressionSizes[i]);
-
-    for (std::size_t i = 0; i < parameters.conditionCount + 1; ++i) {
-        if (parameters.modifyExpressionSizes[i]) {
-            m_modifyExpressions[i].assign(parameters.modifyExpressions[i],
-                                          parameters.modifyExpressions[i] + 
-                                          parameters.modifyExpressionSizes[i]);
-        } else {
-            Expression().swap(m_modifyExpressions[i]);
-        }
-    }
+    code.shrink_to_fit();
+    m_code = std::move(code);
+    m_conditionPrograms = std::move(conditionPrograms);
+    m_modifyPrograms = std::move(modifyPrograms);
 
+    optimize(nullptr);
     return {};
 }
 
@@ -161,11 +159,8 @@ void ObjectBehaviour::activate(ExecutionTarget& target, const ExecutionArguments
         return;
 
     std::size_t commandIndex = 0;
-    while (commandIndex < m_conditionExpressions.size()) {
-        const auto& currentExpression = m_conditionExpressions[commandIndex];
-
-        if (computeValueExpression(currentExpression.data(),
-            currentExpression.size(), target, arguments))
+    while (commandIndex < m_conditionPrograms.size()) {
+        if (computeValueExpression(m_conditionPrograms[commandIndex], target, arguments))
             break;
 
         ++commandIndex;
@@ -175,7 +170,16 @@ void ObjectBehaviour::activate(ExecutionTarget& target, const ExecutionArguments
     if (commandIndex >= m_commands.size())
         return;
 
-    const auto& activeModifyExpression = m_modifyExpressions[commandIndex];
+    const Program& activeModifyProgram = m_modifyPrograms[commandIndex];
+
+    if constexpr (BehaviourProfiler::Enabled) {
+        // the conditions up to the true one and the expression of the command (if it's read)
+        std::size_t operationCount = activeModifyProgram.count;
+        for (std::size_t i = 0; i <= commandIndex && i < m_conditionPrograms.size(); ++i)
+            operationCount += m_conditionPrograms[i].count;
+
+        BehaviourProfiler::countCommand(commandIndex, m_conditionPrograms.size(), operationCount);
+    }
 
     switch (m_commands[commandIndex]) {
     case ObjectCommand::KillSnake:
@@ -186,17 +190,14 @@ void ObjectBehaviour::activate(ExecutionTarget& target, const ExecutionArguments
         break;
     case ObjectCommand::ModifyAcceleration:
         target.snakeAcceleration =
-            (Acceleration)computeValueExpression(activeModifyExpression.data(),
-                                      activeModifyExpression.size(), target, arguments);
+            (Acceleration)computeValueExpression(activeModifyProgram, target, arguments);
         break;
     case ObjectCommand::ModifyDirection:
         target.snakeDirection =
-            (Direction)computeValueExpression(activeModifyExpression.data(),
-                                   activeModifyExpression.size(), target, arguments);
+            (Direction)computeValueExpression(activeModifyProgram, target, arguments);
         break;
     case ObjectCommand::Remember:
-        target.remembered = computeValueExpression(activeModifyExpression.data(),
-                                                   activeModifyExpression.size(), target, arguments);
+        target.remembered = computeValueExpression(activeModifyProgram, target, arguments);
         break;
     default:
         break;
@@ -205,521 +206,708 @@ void ObjectBehaviour::activate(ExecutionTarget& target, const ExecutionArguments
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-std::uint32_t ObjectBehaviour::computeValueExpression(
-    const std::uint32_t* expression,
-    std::size_t keywordCount,
-    const ExecutionTarget& target,
-    const ExecutionArguments& arguments) {
-    std::forward_list<std::uint32_t> stack;
-    std::size_t pointer = 0;
-
-    bool isInteger = false;
-
-    bool again = true;
-    while (again) {
-        if (pointer >= keywordCount)
+std::uint32_t ObjectBehaviour::computeValueExpression(const Instruction* instruction,
+                                                      const Instruction* end,
+                                                      const ExecutionTarget& target,
+                                                      const ExecutionArguments& arguments) {
+    // the program was checked by compileValueExpression, so the stack is never overrun;
+    // stack[depth - 1] is the topmost value
+    std::uint32_t stack[MaxStackDepth];
+    std::size_t depth = 0;
+
+    for (; instruction != end; ++instruction) {
+        switch (instruction->keyword) {
+        case ObjectBehaviourKeyword::Int:
+            stack[depth++] = instruction->operand;
             break;
-
-        if (isInteger) {
-            stack.push_front(expression[pointer]);
-            isInteger = false;
-        } else {
-            switch ((ObjectBehaviourKeyword)expression[pointer]) {
-            case ObjectBehaviourKeyword::AccelerationDefault:
-                stack.push_front((std::uint32_t)Acceleration::Default);
-                break;
-            case ObjectBehaviourKeyword::AccelerationDown:
-                stack.push_front((std::uint32_t)Acceleration::Down);
-                break;
-            case ObjectBehaviourKeyword::AccelerationUp:
-                stack.push_front((std::uint32_t)Acceleration::Up);
-                break;
-            case ObjectBehaviourKeyword::RandomAcceleration:
-                stack.push_front((std::uint32_t)arguments.randomizer->get(0, 
-                                 (std::uint64_t)AccelerationCount - 1));
-                break;
-            case ObjectBehaviourKeyword::RandomCombinedDirection:
-                stack.push_front((std::uint32_t)arguments.randomizer->get(0, 
-                                 (std::uint64_t)CombinedTubeCount - 1));
-                break;
-            case ObjectBehaviourKeyword::RandomDirection:
-                stack.push_front((std::uint32_t)arguments.randomizer->get(0, 
-                                 (std::uint64_t)DirectionCount - 1));
-                break;
-            case ObjectBehaviourKeyword::RandomDoubleDirection:
-                stack.push_front((std::uint32_t)arguments.randomizer->get(0, 
-                                 (std::uint64_t)DoubleDirectionCount - 1));
-                break;
-            case ObjectBehaviourKeyword::IntRandomValue:
-                stack.front() = (std::uint32_t)arguments.randomizer->get(0,
-                                                                         stack.front());
-                break;
-            case ObjectBehaviourKeyword::RememberedInt:
-                stack.push_front(target.remembered);
-                break;
-            case ObjectBehaviourKeyword::Not:
-                stack.front() = static_cast<std::uint32_t>(!static_cast<bool>(stack.front()));
-                break;
-            case ObjectBehaviourKeyword::OppositeDirection:
-                stack.front() = (std::uint32_t)oppositeDirection(Direction(stack.front()));
-                break;
-            case ObjectBehaviourKeyword::OppositeAcceleration:
-                stack.front() = (std::uint32_t)oppositeAcceleration((Acceleration)stack.front());
-                break;
-            case ObjectBehaviourKeyword::Or:
-            {
-                bool reserved = stack.front();
-                stack.pop_front();
-                stack.front() =
-                    static_cast<std::uint32_t>(reserved || static_cast<bool>(stack.front()));
-                break;
-            }
-            case ObjectBehaviourKeyword::And:
-            {
-                bool reserved = stack.front();
-                stack.pop_front();
-                stack.front() =
-                    static_cast<std::uint32_t>(reserved && static_cast<bool>(stack.front()));
-                break;
-            }
-            case ObjectBehaviourKeyword::Equal:
-            {
-                std::uint32_t reserved = stack.front();
-                stack.pop_front();
-                stack.front() = std::uint32_t(stack.front() == reserved);
-                break;
-            }
-            case ObjectBehaviourKeyword::Select:
-            {
-                bool selectFarther = stack.front();
-                stack.pop_front();
-
-                if (selectFarther)
-                    stack.pop_front();
-                else
-                    stack.erase_after(stack.begin());
-
-                break;
-            }
-            case ObjectBehaviourKeyword::IsDirExitOfDoubleDir:
-            {
-                Direction reserved = (Direction)stack.front();
-                stack.pop_front();
-                stack.front() = (std::uint32_t)directionIsExit((DoubleDirection)stack.front(), reserved);
-                break;
-            }
-            case ObjectBehaviourKeyword::GetCombDirExit:
-            {
-                CombinedDirection reserved = (CombinedDirection)stack.front();
-                stack.pop_front();
-                stack.front() = (std::uint32_t)getCombinedTubeExit(reserved, (Direction)stack.front());
-                break;
-            }
-            case ObjectBehaviourKeyword::SnakeAcceleration:
-                stack.push_front((std::uint32_t)target.snakeAcceleration);
-                break;
-            case ObjectBehaviourKeyword::SnakeDirection:
-                stack.push_front((std::uint32_t)target.snakeDirection);
-                break;
-            case ObjectBehaviourKeyword::PreviousSnakeDirection:
-                stack.push_front((std::uint32_t)arguments.previousSnakeDirection);
-                break;
-            case ObjectBehaviourKeyword::ParamAcceleration:
-            case ObjectBehaviourKeyword::ParamDirection:
-            case ObjectBehaviourKeyword::ParamDoubleDirection:
-            case ObjectBehaviourKeyword::ParamCombinedDirection:
-                stack.push_front(arguments.parameter);
-                break;
-            case ObjectBehaviourKeyword::Int:
-                isInteger = true;
-                break;
-            case ObjectBehaviourKeyword::IntAdd:
-            {
-                std::uint32_t intval = stack.front();
-                stack.pop_front();
-                stack.front() += intval;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntSubtract:
-            {
-                std::uint32_t intval = stack.front();
-                stack.pop_front();
-                stack.front() -= intval;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntAddOverflow:
-            {
-                std::uint32_t intval = stack.front();
-                stack.pop_front();
-                stack.front() = (UINT32_MAX - intval < stack.front());
-                break;
-            }
-            case ObjectBehaviourKeyword::IntBitAnd:
-            {
-                std::uint32_t intval = stack.front();
-                stack.pop_front();
-                stack.front() &= intval;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntBitNot:
-                stack.front() = ~stack.front();
-                break;
-            case ObjectBehaviourKeyword::IntBitOr:
-            {
-                std::uint32_t intval = stack.front();
-                stack.pop_front();
-                stack.front() |= intval;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntBitXor:
-            {
-                std::uint32_t intval = stack.front();
-                stack.pop_front();
-                stack.front() ^= intval;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntCountOfOnes:
-            {
-                unsigned int howmany = 0;
-                for (std::uint32_t i = 1; i; i <<= 1) {
-                    if (stack.front() & i)
-                        ++howmany;
-                }
-                stack.front() = howmany;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntCyclicLeftShift:
-            {
-                std::uint32_t intmod = stack.front();
-                stack.pop_front();
-                intmod %= 32;
-                std::uint32_t intsrc = stack.front();
-                stack.front() <<= intmod;
-                intsrc >>= (32 - intmod);
-                stack.front() |= intsrc;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntCyclicRightShift:
-            {
-                std::uint32_t intmod = stack.front();
-                stack.pop_front();
-                intmod %= 32;
-                std::uint32_t intsrc = stack.front();
-                stack.front() >>= intmod;
-                intsrc <<= (32 - intmod);
-                stack.front() |= intsrc;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntDivideAndFloor:
-            {
-                std::uint32_t divisor = stack.front();
-                stack.pop_front();
-                if (divisor == 0)
-                    stack.front() = 0;
-                else
-                    stack.front() /= divisor;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntLess:
-            {
-                std::uint32_t rightVal = stack.front();
-                stack.pop_front();
-                stack.front() = (stack.front() < rightVal);
-                break;
-            }
-            case ObjectBehaviourKeyword::IntLogicalLeftShift:
-            {
-                std::uint32_t intval = stack.front();
-                stack.pop_front();
-                stack.front() <<= intval;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntLogicalRightShift:
-            {
-                std::uint32_t intval = stack.front();
-                stack.pop_front();
-                stack.front() >>= intval;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntMinus:
-                stack.front() = UINT32_MAX - stack.front();
-                break;
-            case ObjectBehaviourKeyword::IntModulo:
-            {
-                std::uint32_t divisor = stack.front();
-                stack.pop_front();
-                if (divisor == 0)
-                    stack.front() = 0;
-                else
-                    stack.front() %= divisor;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntMultiply:
-            {
-                std::uint32_t intval = stack.front();
-                stack.pop_front();
-                stack.front() *= intval;
-                break;
-            }
-            case ObjectBehaviourKeyword::IntMultiplyOverflow:
-            {
-                std::uint64_t intval = stack.front();
-                stack.pop_front();
-                std::uint64_t product64 = intval * stack.front();
-                stack.front() = (product64 > UINT32_MAX);
-                break;
-            }
-            case ObjectBehaviourKeyword::ExpressionEnd:
-            default:
-                again = false;
-                break;
+        case ObjectBehaviourKeyword::RandomAcceleration:
+            stack[depth++] = (std::uint32_t)arguments.randomizer->get(0,
+                                    (std::uint64_t)AccelerationCount - 1);
+            break;
+        case ObjectBehaviourKeyword::RandomCombinedDirection:
+            stack[depth++] = (std::uint32_t)arguments.randomizer->get(0,
+                                    (std::uint64_t)CombinedTubeCount - 1);
+            break;
+        case ObjectBehaviourKeyword::RandomDirection:
+            stack[depth++] = (std::uint32_t)arguments.randomizer->get(0,
+                                    (std::uint64_t)DirectionCount - 1);
+            break;
+        case ObjectBehaviourKeyword::RandomDoubleDirection:
+            stack[depth++] = (std::uint32_t)arguments.randomizer->get(0,
+                                    (std::uint64_t)DoubleDirectionCount - 1);
+            break;
+        case ObjectBehaviourKeyword::IntRandomValue:
+            stack[depth - 1] = (std::uint32_t)arguments.randomizer->get(0, stack[depth - 1]);
+            break;
+        case ObjectBehaviourKeyword::RememberedInt:
+            stack[depth++] = target.remembered;
+            break;
+        case ObjectBehaviourKeyword::Not:
+            stack[depth - 1] = static_cast<std::uint32_t>(!static_cast<bool>(stack[depth - 1]));
+            break;
+        case ObjectBehaviourKeyword::OppositeDirection:
+            stack[depth - 1] = (std::uint32_t)oppositeDirection(Direction(stack[depth - 1]));
+            break;
+        case ObjectBehaviourKeyword::OppositeAcceleration:
+            stack[depth - 1] = (std::uint32_t)oppositeAcceleration((Acceleration)stack[depth - 1]);
+            break;
+        case ObjectBehaviourKeyword::Or:
+            --depth;
+            stack[depth - 1] = static_cast<std::uint32_t>(static_cast<bool>(stack[depth]) || static_cast<bool>(stack[depth - 1]));
+            break;
+        case ObjectBehaviourKeyword::And:
+            --depth;
+            stack[depth - 1] = static_cast<std::uint32_t>(static_cast<bool>(stack[depth]) && static_cast<bool>(stack[depth - 1]));
+            break;
+        case ObjectBehaviourKeyword::Equal:
+            --depth;
+            stack[depth - 1] = std::uint32_t(stack[depth - 1] == stack[depth]);
+            break;
+        case ObjectBehaviourKeyword::Select:
+            // the farther value if the condition holds, the topmost one otherwise
+            depth -= 2;
+            if (!stack[depth + 1])
+                stack[depth - 1] = stack[depth];
+            break;
+        case ObjectBehaviourKeyword::IsDirExitOfDoubleDir:
+            --depth;
+            stack[depth - 1] = (std::uint32_t)directionIsExit((DoubleDirection)stack[depth - 1], (Direction)stack[depth]);
+            break;
+        case ObjectBehaviourKeyword::GetCombDirExit:
+            --depth;
+            stack[depth - 1] = (std::uint32_t)getCombinedTubeExit((CombinedDirection)stack[depth], (Direction)stack[depth - 1]);
+            break;
+        case ObjectBehaviourKeyword::SnakeAcceleration:
+            stack[depth++] = (std::uint32_t)target.snakeAcceleration;
+            break;
+        case ObjectBehaviourKeyword::SnakeDirection:
+            stack[depth++] = (std::uint32_t)target.snakeDirection;
+            break;
+        case ObjectBehaviourKeyword::PreviousSnakeDirection:
+            stack[depth++] = (std::uint32_t)arguments.previousSnakeDirection;
+            break;
+        case ObjectBehaviourKeyword::ParamAcceleration:
+        case ObjectBehaviourKeyword::ParamDirection:
+        case ObjectBehaviourKeyword::ParamDoubleDirection:
+        case ObjectBehaviourKeyword::ParamCombinedDirection:
+            stack[depth++] = arguments.parameter;
+            break;
+        case ObjectBehaviourKeyword::IntAdd:
+            --depth;
+            stack[depth - 1] += stack[depth];
+            break;
+        case ObjectBehaviourKeyword::IntSubtract:
+            --depth;
+            stack[depth - 1] -= stack[depth];
+            break;
+        case ObjectBehaviourKeyword::IntAddOverflow:
+            --depth;
+            stack[depth - 1] = (UINT32_MAX - stack[depth] < stack[depth - 1]);
+            break;
+        case ObjectBehaviourKeyword::IntBitAnd:
+            --depth;
+            stack[depth - 1] &= stack[depth];
+            break;
+        case ObjectBehaviourKeyword::IntBitNot:
+            stack[depth - 1] = ~stack[depth - 1];
+            break;
+        case ObjectBehaviourKeyword::IntBitOr:
+            --depth;
+            stack[depth - 1] |= stack[depth];
+            break;
+        case ObjectBehaviourKeyword::IntBitXor:
+            --depth;
+            stack[depth - 1] ^= stack[depth];
+            break;
+        case ObjectBehaviourKeyword::IntCountOfOnes:
+        {
+            unsigned int howmany = 0;
+            for (std::uint32_t i = 1; i; i <<= 1) {
+                if (stack[depth - 1] & i)
+                    ++howmany;
             }
+            stack[depth - 1] = howmany;
+            break;
+        }
+        case ObjectBehaviourKeyword::IntCyclicLeftShift:
+        {
+            --depth;
+            std::uint32_t intmod = stack[depth] % 32;
+            std::uint32_t intsrc = stack[depth - 1];
+            stack[depth - 1] <<= intmod;
+            intsrc >>= (32 - intmod) % 32;
+            stack[depth - 1] |= intsrc;
+            break;
+        }
+        case ObjectBehaviourKeyword::IntCyclicRightShift:
+        {
+            --depth;
+            std::uint32_t intmod = stack[depth] % 32;
+            std::uint32_t intsrc = stack[depth - 1];
+            stack[depth - 1] >>= intmod;
+            intsrc <<= (32 - intmod) % 32;
+            stack[depth - 1] |= intsrc;
+            break;
+        }
+        case ObjectBehaviourKeyword::IntDivideAndFloor:
+            --depth;
+            if (stack[depth] == 0)
+                stack[depth - 1] = 0;
+            else
+                stack[depth - 1] /= stack[depth];
+            break;
+        case ObjectBehaviourKeyword::IntLess:
+            --depth;
+            stack[depth - 1] = (stack[depth - 1] < stack[depth]);
+            break;
+        case ObjectBehaviourKeyword::IntLogicalLeftShift:
+            // the shifts count modulo 32 as the x86 ones
+            --depth;
+            stack[depth - 1] <<= stack[depth] % 32;
+            break;
+        case ObjectBehaviourKeyword::IntLogicalRightShift:
+            --depth;
+            stack[depth - 1] >>= stack[depth] % 32;
+            break;
+        case ObjectBehaviourKeyword::IntMinus:
+            stack[depth - 1] = UINT32_MAX - stack[depth - 1];
+            break;
+        case ObjectBehaviourKeyword::IntModulo:
+            --depth;
+            if (stack[depth] == 0)
+                stack[depth - 1] = 0;
+            else
+                stack[depth - 1] %= stack[depth];
+            break;
+        case ObjectBehaviourKeyword::IntMultiply:
+            --depth;
+            stack[depth - 1] *= stack[depth];
+            break;
+        case ObjectBehaviourKeyword::IntMultiplyOverflow:
+        {
+            --depth;
+            std::uint64_t product64 = (std::uint64_t)stack[depth] * stack[depth - 1];
+            stack[depth - 1] = (product64 > UINT32_MAX);
+            break;
+        }
+        default:
+            assert(false);
+            break;
         }
-
-        ++pointer;
     }
 
-    return stack.front();
+    return stack[depth - 1];
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-std::optional<std::string> ObjectBehaviour::validateValueExpression(StackValueType type,
-                                                                    const std::uint32_t* expression,
-                                                                    std::size_t keywordCount,
-                                                                    EffectAttributeStates& states) {
+std::optional<std::string> ObjectBehaviour::compileValueExpression(StackValueType type,
+                                                                   const std::uint32_t* expression,
+                                                                   std::size_t keywordCount,
+                                                                   EffectAttributeStates& states,
+                                                                   std::vector<Instruction>& code,
+                                                                   Program& program) {
     assert(expression && keywordCount);
 
-    std::forward_list<StackValueType> stack;
-    std::size_t pointer = 0;
+    std::vector<StackValueType> stack;
+    program.first = (std::uint32_t)code.size();
 
-    bool isInteger = false;
+    auto emit = [&code](ObjectBehaviourKeyword keyword, std::uint32_t operand = 0) {
+        code.push_back(Instruction{ keyword, operand });
+    };
+
+    std::size_t pointer = 0;
 
     bool again = true;
-    while (again) {
-        if (pointer >= keywordCount)
-            break;
-
-        if (isInteger) {
-            stack.push_front(StackValueType::Integer);
-            isInteger = false;
-        } else {
-            switch ((ObjectBehaviourKeyword)expression[pointer]) {
-            case ObjectBehaviourKeyword::AccelerationDown:
-            case ObjectBehaviourKeyword::AccelerationDefault:
-            case ObjectBehaviourKeyword::AccelerationUp:
-                stack.push_front(StackValueType::Acceleration);
-                break;
+    while (again && pointer < keywordCount) {
+        ObjectBehaviourKeyword keyword = (ObjectBehaviourKeyword)expression[pointer];
 
-            case ObjectBehaviourKeyword::RandomAcceleration:
-                stack.push_front(StackValueType::Acceleration);
-                states.requiresRandom = true;
-                break;
+        switch (keyword) {
+        case ObjectBehaviourKeyword::AccelerationDown:
+            stack.push_back(StackValueType::Acceleration);
+            emit(ObjectBehaviourKeyword::Int, (std::uint32_t)Acceleration::Down);
+            break;
 
-            case ObjectBehaviourKeyword::IntRandomValue:
+        case ObjectBehaviourKeyword::AccelerationDefault:
+            stack.push_back(StackValueType::Acceleration);
+            emit(ObjectBehaviourKeyword::Int, (std::uint32_t)Acceleration::Default);
+            break;
 
-                if (stack.empty() || stack.front() != StackValueType::Integer)
-                    return "TODO";
+        case ObjectBehaviourKeyword::AccelerationUp:
+            stack.push_back(StackValueType::Acceleration);
+            emit(ObjectBehaviourKeyword::Int, (std::uint32_t)Acceleration::Up);
+            break;
 
-                states.requiresRandom = true;
-                break;
+        case ObjectBehaviourKeyword::RandomAcceleration:
+            stack.push_back(StackValueType::Acceleration);
+            states.requiresRandom = true;
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::RandomCombinedDirection:
-                stack.push_front(StackValueType::CombinedDirection);
-                states.requiresRandom = true;
-                break;
+        case ObjectBehaviourKeyword::IntRandomValue:
 
-            case ObjectBehaviourKeyword::RandomDirection:
-                stack.push_front(StackValueType::Direction);
-                states.requiresRandom = true;
-                break;
+            if (stack.empty() || stack.back() != StackValueType::Integer)
+                return "TODO";
 
-            case ObjectBehaviourKeyword::RandomDoubleDirection:
-                stack.push_front(StackValueType::DoubleDirection);
-                states.requiresRandom = true;
-                break;
+            states.requiresRandom = true;
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::RememberedInt:
+        case ObjectBehaviourKeyword::RandomCombinedDirection:
+            stack.push_back(StackValueType::CombinedDirection);
+            states.requiresRandom = true;
+            emit(keyword);
+            break;
 
-                stack.push_front(StackValueType::Integer);
-                break;
+        case ObjectBehaviourKeyword::RandomDirection:
+            stack.push_back(StackValueType::Direction);
+            states.requiresRandom = true;
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::OppositeDirection:
-                if (stack.empty() || stack.front() != StackValueType::Direction)
-                    return "Lack of value in the stack (Direction)";
+        case ObjectBehaviourKeyword::RandomDoubleDirection:
+            stack.push_back(StackValueType::DoubleDirection);
+            states.requiresRandom = true;
+            emit(keyword);
+            break;
 
-                break;
+        case ObjectBehaviourKeyword::RememberedInt:
 
-            case ObjectBehaviourKeyword::OppositeAcceleration:
-                if (stack.empty() || stack.front() != StackValueType::Acceleration)
-                    return "Lack of value in the stack (Acceleration)";
+            stack.push_back(StackValueType::Integer);
+            emit(keyword);
+            break;
 
-                break;
+        case ObjectBehaviourKeyword::OppositeDirection:
+            if (stack.empty() || stack.back() != StackValueType::Direction)
+                return "Lack of value in the stack (Direction)";
 
-            case ObjectBehaviourKeyword::Or:
-            case ObjectBehaviourKeyword::And:
-            case ObjectBehaviourKeyword::IntAdd:
-            case ObjectBehaviourKeyword::IntAddOverflow:
-            case ObjectBehaviourKeyword::IntBitAnd:
-            case ObjectBehaviourKeyword::IntBitOr:
-            case ObjectBehaviourKeyword::IntBitXor:
-            case ObjectBehaviourKeyword::IntCyclicLeftShift:
-            case ObjectBehaviourKeyword::IntCyclicRightShift:
-            case ObjectBehaviourKeyword::IntDivideAndFloor:
-            case ObjectBehaviourKeyword::IntLogicalLeftShift:
-            case ObjectBehaviourKeyword::IntLogicalRightShift:
-            case ObjectBehaviourKeyword::IntModulo:
-            case ObjectBehaviourKeyword::IntMultiply:
-            case ObjectBehaviourKeyword::IntMultiplyOverflow:
-            case ObjectBehaviourKeyword::IntSubtract:
-            case ObjectBehaviourKeyword::IntLess:
-                if (stack.empty() || stack.front() != StackValueType::Integer)
-                    return "Lack of value in the stack (Int)";
-
-                stack.pop_front();
-                [[fallthrough]];
-
-            case ObjectBehaviourKeyword::Not:
-            case ObjectBehaviourKeyword::IntBitNot:
-            case ObjectBehaviourKeyword::IntCountOfOnes:
-            case ObjectBehaviourKeyword::IntMinus:
-                if (stack.empty() || stack.front() != StackValueType::Integer)
-                    return "Lack of value in the stack (Int)";
+            emit(keyword);
+            break;
 
-                break;
+        case ObjectBehaviourKeyword::OppositeAcceleration:
+            if (stack.empty() || stack.back() != StackValueType::Acceleration)
+                return "Lack of value in the stack (Acceleration)";
 
-            case ObjectBehaviourKeyword::Equal:
-            {
-                if (stack.empty())
-                    return "Lack of value in the stack (empty)";
+            emit(keyword);
+            break;
 
-                StackValueType currentType = stack.front();
-                stack.pop_front();
+        case ObjectBehaviourKeyword::Or:
+        case ObjectBehaviourKeyword::And:
+        case ObjectBehaviourKeyword::IntAdd:
+        case ObjectBehaviourKeyword::IntAddOverflow:
+        case ObjectBehaviourKeyword::IntBitAnd:
+        case ObjectBehaviourKeyword::IntBitOr:
+        case ObjectBehaviourKeyword::IntBitXor:
+        case ObjectBehaviourKeyword::IntCyclicLeftShift:
+        case ObjectBehaviourKeyword::IntCyclicRightShift:
+        case ObjectBehaviourKeyword::IntDivideAndFloor:
+        case ObjectBehaviourKeyword::IntLogicalLeftShift:
+        case ObjectBehaviourKeyword::IntLogicalRightShift:
+        case ObjectBehaviourKeyword::IntModulo:
+        case ObjectBehaviourKeyword::IntMultiply:
+        case ObjectBehaviourKeyword::IntMultiplyOverflow:
+        case ObjectBehaviourKeyword::IntSubtract:
+        case ObjectBehaviourKeyword::IntLess:
+            if (stack.empty() || stack.back() != StackValueType::Integer)
+                return "Lack of value in the stack (Int)";
+
+            stack.pop_back();
+            [[fallthrough]];
+
+        case ObjectBehaviourKeyword::Not:
+        case ObjectBehaviourKeyword::IntBitNot:
+        case ObjectBehaviourKeyword::IntCountOfOnes:
+        case ObjectBehaviourKeyword::IntMinus:
+            if (stack.empty() || stack.back() != StackValueType::Integer)
+                return "Lack of value in the stack (Int)";
+
+            emit(keyword);
+            break;
 
-                if (stack.empty() || currentType != stack.front())
-                    return "Lack of value in the stack: wrong type";
+        case ObjectBehaviourKeyword::Equal:
+        {
+            if (stack.empty())
+                return "Lack of value in the stack (empty)";
 
-                if (currentType != StackValueType::Integer) {
-                    stack.pop_front();
-                    stack.push_front(StackValueType::Integer);
-                }
+            StackValueType currentType = stack.back();
+            stack.pop_back();
 
-                break;
-            }
-            case ObjectBehaviourKeyword::Select:
-            {
-                if (stack.empty() || stack.front() != StackValueType::Integer)
-                    return "Lack of value in the stack (Boolean)";
+            if (stack.empty() || currentType != stack.back())
+                return "Lack of value in the stack: wrong type";
 
-                stack.pop_front();
+            stack.back() = StackValueType::Integer;
+            emit(keyword);
+            break;
+        }
+        case ObjectBehaviourKeyword::Select:
+        {
+            if (stack.empty() || stack.back() != StackValueType::Integer)
+                return "Lack of value in the stack (Boolean)";
 
-                if (stack.empty())
-                    return "Lack of value in the stack (empty)";
+            stack.pop_back();
 
-                StackValueType currentType = stack.front();
-                stack.pop_front();
+            if (stack.empty())
+                return "Lack of value in the stack (empty)";
 
-                if (stack.empty() || currentType != stack.front())
-                    return "Lack of value in the stack: wrong type";
+            StackValueType currentType = stack.back();
+            stack.pop_back();
 
-                if (currentType != StackValueType::Integer) {
-                    stack.pop_front();
-                    stack.push_front(currentType);
-                }
+            if (stack.empty() || currentType != stack.back())
+                return "Lack of value in the stack: wrong type";
 
-                break;
-            }
-            case ObjectBehaviourKeyword::IsDirExitOfDoubleDir:
-                if (stack.empty() || stack.front() != StackValueType::Direction)
-                    return "Lack of value in the stack (direction)";
+            emit(keyword);
+            break;
+        }
+        case ObjectBehaviourKeyword::IsDirExitOfDoubleDir:
+            if (stack.empty() || stack.back() != StackValueType::Direction)
+                return "Lack of value in the stack (direction)";
 
-                stack.pop_front();
+            stack.pop_back();
 
-                if (stack.empty() || stack.front() != StackValueType::DoubleDirection)
-                    return "Lack of value in the stack (DoubleDirection)";
+            if (stack.empty() || stack.back() != StackValueType::DoubleDirection)
+                return "Lack of value in the stack (DoubleDirection)";
 
-                stack.pop_front();
-                stack.push_front(StackValueType::Integer);
-                break;
+            stack.back() = StackValueType::Integer;
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::GetCombDirExit:
-                if (stack.empty() || stack.front() != StackValueType::CombinedDirection)
-                    return "Lack of value in the stack (CombinedDirection)";
+        case ObjectBehaviourKeyword::GetCombDirExit:
+            if (stack.empty() || stack.back() != StackValueType::CombinedDirection)
+                return "Lack of value in the stack (CombinedDirection)";
 
-                stack.pop_front();
+            stack.pop_back();
 
-                if (stack.empty() || stack.front() != StackValueType::Direction)
-                    return "Lack of value in the stack (direction)";
+            if (stack.empty() || stack.back() != StackValueType::Direction)
+                return "Lack of value in the stack (direction)";
 
-                break;
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::SnakeAcceleration:
-                stack.push_front(StackValueType::Acceleration);
-                break;
+        case ObjectBehaviourKeyword::SnakeAcceleration:
+            stack.push_back(StackValueType::Acceleration);
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::SnakeDirection:
-            case ObjectBehaviourKeyword::PreviousSnakeDirection:
-                stack.push_front(StackValueType::Direction);
-                break;
+        case ObjectBehaviourKeyword::SnakeDirection:
+        case ObjectBehaviourKeyword::PreviousSnakeDirection:
+            stack.push_back(StackValueType::Direction);
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::ParamAcceleration:
+        case ObjectBehaviourKeyword::ParamAcceleration:
 
-                if (states.paramType != ObjectParameterType::Acceleration &&
-                    states.paramType != ObjectParameterType::NoParameter)
-                    return "Parameter corruption (acceleration)";
+            if (states.paramType != ObjectParameterType::Acceleration &&
+                states.paramType != ObjectParameterType::NoParameter)
+                return "Parameter corruption (acceleration)";
 
-                states.paramType = ObjectParameterType::Acceleration;
-                stack.push_front(StackValueType::Acceleration);
-                break;
+            states.paramType = ObjectParameterType::Acceleration;
+            stack.push_back(StackValueType::Acceleration);
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::ParamDirection:
+        case ObjectBehaviourKeyword::ParamDirection:
 
-                if (states.paramType != ObjectParameterType::Direction &&
-                    states.paramType != ObjectParameterType::NoParameter)
-                    return "Parameter corruption (direction)";
+            if (states.paramType != ObjectParameterType::Direction &&
+                states.paramType != ObjectParameterType::NoParameter)
+                return "Parameter corruption (direction)";
 
-                states.paramType = ObjectParameterType::Direction;
-                stack.push_front(StackValueType::Direction);
-                break;
+            states.paramType = ObjectParameterType::Direction;
+            stack.push_back(StackValueType::Direction);
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::ParamDoubleDirection:
+        case ObjectBehaviourKeyword::ParamDoubleDirection:
 
-                if (states.paramType != ObjectParameterType::DoubleDirection &&
-                    states.paramType != ObjectParameterType::NoParameter)
-                    return "Parameter corruption (double direction)";
+            if (states.paramType != ObjectParameterType::DoubleDirection &&
+                states.paramType != ObjectParameterType::NoParameter)
+                return "Parameter corruption (double direction)";
 
-                states.paramType = ObjectParameterType::DoubleDirection;
-                stack.push_front(StackValueType::DoubleDirection);
-                break;
+            states.paramType = ObjectParameterType::DoubleDirection;
+            stack.push_back(StackValueType::DoubleDirection);
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::ParamCombinedDirection:
+        case ObjectBehaviourKeyword::ParamCombinedDirection:
 
-                if (states.paramType != ObjectParameterType::CombinedDirection &&
-                    states.paramType != ObjectParameterType::NoParameter)
-                    return "Parameter corruption (combined direction)";
+            if (states.paramType != ObjectParameterType::CombinedDirection &&
+                states.paramType != ObjectParameterType::NoParameter)
+                return "Parameter corruption (combined direction)";
 
-                states.paramType = ObjectParameterType::CombinedDirection;
-                stack.push_front(StackValueType::CombinedDirection);
-                break;
+            states.paramType = ObjectParameterType::CombinedDirection;
+            stack.push_back(StackValueType::CombinedDirection);
+            emit(keyword);
+            break;
 
-            case ObjectBehaviourKeyword::Int:
-                isInteger = true;
-                break;
-            case ObjectBehaviourKeyword::ExpressionEnd:
-            default:
-                again = false;
-                break;
+        case ObjectBehaviourKeyword::Int:
+            // the value follows, nothing if it's missing
+            if (++pointer < keywordCount) {
+                stack.push_back(StackValueType::Integer);
+                emit(keyword, expression[pointer]);
             }
+            break;
+
+        case ObjectBehaviourKeyword::ExpressionEnd:
+        default:
+            again = false;
+            break;
         }
+
+        if (stack.size() > MaxStackDepth)
+            return "Expression is too deep";
+
         ++pointer;
     }
 
-    if (stack.empty() || (stack.front() != type))
+    if (stack.empty() || (stack.back() != type))
         return "Expression is invalid: stack is empty or returns wrong type";
 
+    program.count = (std::uint32_t)(code.size() - program.first);
     return {};
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+ObjectBehaviour ObjectBehaviour::specialize(std::uint32_t param) const {
+    ObjectBehaviour behaviour(*this);
+    behaviour.optimize(&param);
+    return behaviour;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ObjectBehaviour::optimize(const std::uint32_t* param) {
+    std::vector<Instruction> code;
+    std::vector<Program> conditionPrograms;
+    std::vector<Program> modifyPrograms;
+    std::vector<ObjectCommand> commands;
+
+    auto optimizeModify = [&](std::size_t index) {
+        const Program& program = m_modifyPrograms[index];
+        modifyPrograms.emplace_back();
+        if (program.count)
+            optimizeProgram(m_code.data() + program.first, m_code.data() + program.first + program.count,
+                            param, code, modifyPrograms.back());
+    };
+
+    std::size_t index = 0;
+    for (; index < m_conditionPrograms.size(); ++index) {
+        const Program& program = m_conditionPrograms[index];
+        Program condition;
+        optimizeProgram(m_code.data() + program.first, m_code.data() + program.first + program.count,
+                        param, code, condition);
+
+        Instruction front = code[condition.first];
+        if (condition.count == 1 && front.keyword == ObjectBehaviourKeyword::Int) {
+            code.pop_back();
+
+            // never true
+            if (!front.operand)
+                continue;
+
+            // always true: the command is the last one
+            break;
+        }
+
+        conditionPrograms.push_back(condition);
+        commands.push_back(m_commands[index]);
+        optimizeModify(index);
+    }
+
+    if (!m_commands.empty()) {
+        commands.push_back(m_commands[index]);
+        optimizeModify(index);
+    }
+
+    // the last conditions doing nothing as well as the rest can be dropped if they draw nothing
+    while (!conditionPrograms.empty() && commands.back() == ObjectCommand::NoCommand &&
+           commands[commands.size() - 2] == ObjectCommand::NoCommand) {
+        const Program& condition = conditionPrograms.back();
+        if (!isPure(code.data() + condition.first, code.data() + condition.first + condition.count))
+            break;
+
+        conditionPrograms.pop_back();
+        commands.erase(commands.end() - 2);
+        modifyPrograms.erase(modifyPrograms.end() - 2);
+    }
+
+    code.shrink_to_fit();
+    m_code = std::move(code);
+    m_conditionPrograms = std::move(conditionPrograms);
+    m_modifyPrograms = std::move(modifyPrograms);
+    m_commands = std::move(commands);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ObjectBehaviour::optimizeProgram(const Instruction* instruction, const Instruction* end,
+                                      const std::uint32_t* param,
+                                      std::vector<Instruction>& code, Program& program) {
+    // The values of the stack: where their instructions start,
+    // if they draw nothing and if they are known
+    struct Value {
+        std::size_t first;
+        bool pure;
+        bool constant;
+    };
+
+    std::vector<Value> stack;
+    program.first = (std::uint32_t)code.size();
+
+    auto push = [&](const Instruction& pushed, bool pure, bool constant) {
+        stack.push_back(Value{ code.size(), pure, constant });
+        code.push_back(pushed);
+    };
+
+    // the known operands and the operation become the result
+    auto fold = [&](std::size_t first) {
+        ExecutionTarget target{};
+        ExecutionArguments arguments;
+        std::uint32_t result = computeValueExpression(code.data() + first, code.data() + code.size(),
+                                                      target, arguments);
+        code.resize(first);
+        push(Instruction{ ObjectBehaviourKeyword::Int, result }, true, true);
+    };
+
+    auto isSame = [&code](std::size_t first, std::size_t other, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (code[first + i].keyword != code[other + i].keyword ||
+                code[first + i].operand != code[other + i].operand)
+                return false;
+        }
+        return true;
+    };
+
+    for (; instruction != end; ++instruction) {
+        switch (instruction->keyword) {
+        case ObjectBehaviourKeyword::Int:
+            push(*instruction, true, true);
+            break;
+
+        case ObjectBehaviourKeyword::ParamAcceleration:
+        case ObjectBehaviourKeyword::ParamDirection:
+        case ObjectBehaviourKeyword::ParamDoubleDirection:
+        case ObjectBehaviourKeyword::ParamCombinedDirection:
+            if (param)
+                push(Instruction{ ObjectBehaviourKeyword::Int, *param }, true, true);
+            else
+                push(*instruction, true, false);
+            break;
+
+        case ObjectBehaviourKeyword::RememberedInt:
+        case ObjectBehaviourKeyword::SnakeAcceleration:
+        case ObjectBehaviourKeyword::SnakeDirection:
+        case ObjectBehaviourKeyword::PreviousSnakeDirection:
+            push(*instruction, true, false);
+            break;
+
+        case ObjectBehaviourKeyword::RandomAcceleration:
+        case ObjectBehaviourKeyword::RandomDirection:
+        case ObjectBehaviourKeyword::RandomDoubleDirection:
+        case ObjectBehaviourKeyword::RandomCombinedDirection:
+            push(*instruction, false, false);
+            break;
+
+        case ObjectBehaviourKeyword::IntRandomValue:
+            code.push_back(*instruction);
+            stack.back().pure = false;
+            stack.back().constant = false;
+            break;
+
+        case ObjectBehaviourKeyword::Not:
+        case ObjectBehaviourKeyword::OppositeDirection:
+        case ObjectBehaviourKeyword::OppositeAcceleration:
+        case ObjectBehaviourKeyword::IntBitNot:
+        case ObjectBehaviourKeyword::IntCountOfOnes:
+        case ObjectBehaviourKeyword::IntMinus:
+        {
+            Value operand = stack.back();
+            stack.pop_back();
+            code.push_back(*instruction);
+
+            if (operand.constant)
+                fold(operand.first);
+            else
+                stack.push_back(operand);
+            break;
+        }
+        case ObjectBehaviourKeyword::Select:
+        {
+            Value condition = stack.back();
+            stack.pop_back();
+            Value top = stack.back();
+            stack.pop_back();
+            Value farther = stack.back();
+            stack.pop_back();
+
+            std::size_t fartherCount = top.first - farther.first;
+            std::size_t topCount = condition.first - top.first;
+
+            if (condition.constant) {
+                bool selectFarther = code[condition.first].operand != 0;
+                const Value& dropped = (selectFarther ? top : farther);
+
+                if (dropped.pure) {
+                    Value selected = (selectFarther ? farther : top);
+                    if (!selectFarther)
+                        std::copy(code.begin() + top.first, code.begin() + condition.first,
+                                  code.begin() + farther.first);
+
+                    code.resize(farther.first + (selectFarther ? fartherCount : topCount));
+                    selected.first = farther.first;
+                    stack.push_back(selected);
+                    break;
+                }
+            } else if (condition.pure && farther.pure && top.pure && fartherCount == topCount &&
+                       isSame(farther.first, top.first, topCount)) {
+                // the same either way
+                code.resize(top.first);
+                stack.push_back(farther);
+                break;
+            }
+
+            code.push_back(*instruction);
+            stack.push_back(Value{ farther.first, condition.pure && farther.pure && top.pure, false });
+            break;
+        }
+        default:
+        {
+            // the binary operations
+            Value right = stack.back();
+            stack.pop_back();
+            Value left = stack.back();
+            stack.pop_back();
+            code.push_back(*instruction);
+
+            if (left.constant && right.constant)
+                fold(left.first);
+            else
+                stack.push_back(Value{ left.first, left.pure && right.pure, false });
+            break;
+        }
+        }
+    }
+
+    program.count = (std::uint32_t)(code.size() - program.first);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ObjectBehaviour::isPure(const Instruction* instruction, const Instruction* end) noexcept {
+    for (; instruction != end; ++instruction) {
+        switch (instruction->keyword) {
+        case ObjectBehaviourKeyword::IntRandomValue:
+        case ObjectBehaviourKeyword::RandomAcceleration:
+        case ObjectBehaviourKeyword::RandomDirection:
+        case ObjectBehaviourKeyword::RandomDoubleDirection:
+        case ObjectBehaviourKeyword::RandomCombinedDirection:
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+
 ObjectParameterType ObjectBehaviour::getParameterType() const noexcept {
     return m_parameterType;
 }
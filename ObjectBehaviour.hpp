@@ -79,6 +79,11 @@ public:
 
     void activate(ExecutionTarget& target, const ExecutionArguments& arguments) const;
 
+    /// The behaviour for one parameter value: the parameter keywords become the value
+    /// and the programs are optimized again, ExecutionArguments::parameter is ignored.
+    /// The outcomes and the random draws are the same as of this behaviour for the value.
+    ObjectBehaviour specialize(std::uint32_t param) const;
+
     /// Get type of parameter that the object require.
     ObjectParameterType getParameterType() const noexcept;
 
@@ -100,21 +105,62 @@ private:
         ObjectParameterType paramType = ObjectParameterType::NoParameter;
     };
 
-    [[nodiscard]] static std::optional<std::string>
-        validateValueExpression(StackValueType type,
-                                const std::uint32_t* program,
-                                std::size_t keywordCount,
-                                EffectAttributeStates& states);
+    /// The deepest stack an expression may take, the values are evaluated on an array of it
+    static constexpr std::size_t MaxStackDepth = 32;
 
-    static std::uint32_t computeValueExpression(const std::uint32_t* program,
-                                                std::size_t keywordCount,
+    /// A compiled keyword: the constants become Int with the value inlined,
+    /// the other keywords are kept as they are
+    struct Instruction {
+        ObjectBehaviourKeyword keyword;
+        std::uint32_t operand; // Int only
+    };
+
+    /// An expression: the instructions of m_code from the first one on
+    struct Program {
+        std::uint32_t first = 0;
+        std::uint32_t count = 0;
+    };
+
+    /// Validates the expression and appends its instructions to the code.
+    /// The compiled expression never underflows nor overflows the stack (MaxStackDepth)
+    /// and leaves the value of the type on the top, so it's run without any check.
+    [[nodiscard]] static std::optional<std::string>
+        compileValueExpression(StackValueType type,
+                               const std::uint32_t* expression,
+                               std::size_t keywordCount,
+                               EffectAttributeStates& states,
+                               std::vector<Instruction>& code,
+                               Program& program);
+
+    std::uint32_t computeValueExpression(const Program& program,
+                                         const ExecutionTarget& target,
+                                         const ExecutionArguments& arguments) const {
+        return computeValueExpression(m_code.data() + program.first,
+                                      m_code.data() + program.first + program.count,
+                                      target, arguments);
+    }
+
+    static std::uint32_t computeValueExpression(const Instruction* instruction,
+                                                const Instruction* end,
                                                 const ExecutionTarget& target,
                                                 const ExecutionArguments& arguments);
 
-    using Expression = std::vector<std::uint32_t>;
+    /// Constant folding and Select simplification of every program, then the conditions
+    /// known to be false are dropped and the first one known to be true ends the chain.
+    /// param: the value of the parameter keywords, unknown if null.
+    /// Nothing that draws a random value is ever dropped.
+    void optimize(const std::uint32_t* param);
+
+    /// Appends the optimized instructions of the program to the code
+    static void optimizeProgram(const Instruction* instruction, const Instruction* end,
+                                const std::uint32_t* param,
+                                std::vector<Instruction>& code, Program& program);
+
+    static bool isPure(const Instruction* instruction, const Instruction* end) noexcept;
 
-    std::vector<Expression> m_conditionExpressions;           // doesn't have any empty conditions!
-    std::vector<Expression> m_modifyExpressions;              // expressions can be empty, but the vector can't be
+    std::vector<Instruction> m_code;                // all the expressions
+    std::vector<Program> m_conditionPrograms;       // doesn't have any empty conditions!
+    std::vector<Program> m_modifyPrograms;          // programs can be empty, but the vector can't be
     std::vector<ObjectCommand> m_commands;          // if it's empty, there is 'empty behaviour'
 
     std::bitset<ObjectPropertyCount> m_properties;
@@ -27,7 +27,7 @@
 #include <SFML/System/InputStream.hpp>
 #include "BasicUtility.hpp"
 #include <array>
-#include <unordered_map>
+#include <vector>
 #include <algorithm>
 #include "Endianness.hpp"
 
@@ -37,54 +37,80 @@ namespace CrazySnakes {
 std::optional<std::string> 
 ObjectBehaviourLoader::loadFromStream(std::vector<ObjectBehaviour>& objBehvrs,    
                                       sf::InputStream& stream, bool endiannessRequired) {
-                                                                
-    // kw map (from keyword to bin value, we need reversed one)
-    std::array<std::uint32_t, ObjectKeywordCount> objectKwMap{};
-    std::int64_t finstatus;
+    sf::Int64 position = stream.tell();
+    if (position < 0)
+        return "Object behavior file opening failure";
 
-    finstatus = stream.read(objectKwMap.data(), sizeof(std::uint32_t) * ObjectKeywordCount);
-    if (finstatus != sizeof(std::uint32_t) * ObjectKeywordCount)
-        return "Object behavior keyword map opening failure";
+    // Read by the growing chunks and decoded in memory, until the end of the section is read.
+    // A cut section is decoded with no error (as the one cut by the end of the stream)
+    std::vector<std::uint32_t> words;
+    std::size_t readCount = 0;
+
+    for (std::size_t chunk = StreamChunkSize;; chunk *= 2) {
+        std::size_t oldSize = words.size();
+        words.resize(oldSize + chunk);
+
+        sf::Int64 byteCount = stream.read(words.data() + oldSize, (sf::Int64)(chunk * sizeof(std::uint32_t)));
+        if (byteCount < 0)
+            return "Object behavior file opening failure";
+
+        words.resize(oldSize + (std::size_t)byteCount / sizeof(std::uint32_t));
+
+        // endianness
+        if (endiannessRequired) {
+            std::for_each(words.begin() + oldSize, words.end(),
+                          [](std::uint32_t& v) {
+                              v = n2hl(v);
+                          });
+        }
 
-    // endianness
-    if (endiannessRequired) {
-        std::for_each(objectKwMap.begin(), objectKwMap.end(),
-                      [](std::uint32_t& v) {
-                          v = n2hl(v);
-                      });
+        std::optional<std::string> log{ loadFromMemory(objBehvrs, words.data(), words.size(), readCount) };
+        if (log)
+            return log;
+
+        bool streamEnded = words.size() < oldSize + chunk;
+        if (readCount < words.size() || streamEnded)
+            break;
     }
 
-    // TODO: check the kw map
-    std::unordered_map<std::uint32_t, ObjectBehaviourKeyword> objectKwRevMap;
+    // the next section
+    sf::Int64 next = position + (sf::Int64)(readCount * sizeof(std::uint32_t));
+    if (stream.seek(next) != next)
+        return "Object behavior file opening failure";
 
-    for (int i = 0; i < ObjectKeywordCount; ++i)
-        objectKwRevMap[objectKwMap[i]] = ObjectBehaviourKeyword(i);
+    return {};
+}
 
-    // behaviour
-    StuffForCreating stuffFc;
 
-    std::uint32_t inputData;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::optional<std::string>
+ObjectBehaviourLoader::loadFromMemory(std::vector<ObjectBehaviour>& objBehvrs, const std::uint32_t* data,
+                                      std::size_t wordCount, std::size_t& readCount) {
+    // kw map (from keyword to bin value, we need reversed one)
+    if (wordCount < (std::size_t)ObjectKeywordCount)
+        return "Object behavior keyword map opening failure";
 
-    bool isInteger = false;
+    const std::uint32_t* objectKwMap = data;
 
-    for (;;) {
-        if (stuffFc.context == Context::Ended)
-            break;
+    // reversed densely, Count if not a keyword
+    std::uint32_t maxValue = *std::max_element(objectKwMap, objectKwMap + ObjectKeywordCount);
+    if (maxValue >= KeywordValueLimit)
+        return "Object behavior keyword map failure";
 
-        finstatus = stream.read(&inputData, 4);
+    std::vector<ObjectBehaviourKeyword> objectKwRevMap((std::size_t)maxValue + 1, ObjectBehaviourKeyword::Count);
 
-        if (finstatus == 0)
-            break;
+    for (int i = 0; i < ObjectKeywordCount; ++i)
+        objectKwRevMap[objectKwMap[i]] = ObjectBehaviourKeyword(i);
 
-        if (finstatus != 4)
-            return "Object behavior file opening failure";
+    // behaviour
+    StuffForCreating stuffFc;
 
-        // endianness
-        if (endiannessRequired) {
-            inputData = n2hl(inputData);
-        }
+    bool isInteger = false;
 
-        stuffFc.input = inputData;
+    std::size_t pointer = ObjectKeywordCount;
+
+    for (; pointer < wordCount && stuffFc.context != Context::Ended; ++pointer) {
+        stuffFc.input = data[pointer];
 
         switch (stuffFc.context) {
         case Context::InputingCommand:
@@ -94,30 +120,30 @@ ObjectBehaviourLoader::loadFromStream(std::vector<ObjectBehaviour>& objBehvrs,
             break;
         case Context::InputingConditionExpr:
         case Context::InputingCommandExpr:
+        {
+            StuffForCreating::Expression& expression = (stuffFc.context == Context::InputingConditionExpr ?
+                                                        stuffFc.condExp.back() : stuffFc.modExp.back());
 
             if (isInteger) {
-                if (stuffFc.context == Context::InputingConditionExpr)
-                    stuffFc.condExp.back().push_back(stuffFc.input);
-                else
-                    stuffFc.modExp.back().push_back(stuffFc.input);
-
+                stuffFc.arena.push_back(stuffFc.input);
+                ++expression.size;
                 isInteger = false;
             } else if (stuffFc.input != objectKwMap[(std::size_t)ObjectBehaviourKeyword::ExpressionEnd]) {
-                auto found = objectKwRevMap.find(stuffFc.input);
-                if (found == objectKwRevMap.end())
+                ObjectBehaviourKeyword found = (stuffFc.input <= maxValue ? objectKwRevMap[stuffFc.input] :
+                                                ObjectBehaviourKeyword::Count);
+                if (found == ObjectBehaviourKeyword::Count)
                     return "Object behavior stack value input failure";
 
-                if (stuffFc.context == Context::InputingConditionExpr)
-                    stuffFc.condExp.back().push_back((std::uint32_t)found->second);
-                else
-                    stuffFc.modExp.back().push_back((std::uint32_t)found->second);
+                stuffFc.arena.push_back((std::uint32_t)found);
+                ++expression.size;
 
-                if (found->second == ObjectBehaviourKeyword::Int)
+                if (found == ObjectBehaviourKeyword::Int)
                     isInteger = true;
             } else {
                 stuffFc.context = Context::KeywordExpected;
             }
             break;
+        }
         case Context::KeywordExpected:
         {
             std::optional<std::string> kwLog{ stuffFc.inputKeyword() };
@@ -132,6 +158,7 @@ ObjectBehaviourLoader::loadFromStream(std::vector<ObjectBehaviour>& objBehvrs,
     }
 
     // success
+    readCount = pointer;
     objBehvrs = std::move(stuffFc.objBehPrep);
     return {};
 }
@@ -145,7 +172,7 @@ std::optional<std::string> ObjectBehaviourLoader::StuffForCreating::createObject
 
     else if (obcommands.size() == condExp.size()) {
         obcommands.push_back(ObjectCommand::NoCommand);
-        modExp.emplace_back();
+        modExp.push_back(Expression{ arena.size(), 0 });
     }
 
     ObjectBehaviour::CompileParameters param;
@@ -160,13 +187,13 @@ std::optional<std::string> ObjectBehaviourLoader::StuffForCreating::createObject
         modSizes(modExp.size());
 
     for (std::size_t i = 0; i < condExp.size(); ++i) {
-        condPtrs[i] = condExp[i].data();
-        condSizes[i] = condExp[i].size();
+        condPtrs[i] = arena.data() + condExp[i].first;
+        condSizes[i] = condExp[i].size;
     }
 
     for (std::size_t i = 0; i < modExp.size(); ++i) {
-        modPtrs[i] = modExp[i].data();
-        modSizes[i] = modExp[i].size();
+        modPtrs[i] = arena.data() + modExp[i].first;
+        modSizes[i] = modExp[i].size;
     }
 
     param.condExpressions = condPtrs.data();
@@ -185,6 +212,7 @@ std::optional<std::string> ObjectBehaviourLoader::StuffForCreating::createObject
     objBehPrep.push_back(std::move(newbie));
 
     // clear
+    arena.clear();
     condExp.clear();
     obcommands.clear();
     modExp.clear();
@@ -211,7 +239,7 @@ bool ObjectBehaviourLoader::StuffForCreating::inputCommand() {
     obcommands.push_back((ObjectCommand)input);
 
     // anyway!
-    modExp.emplace_back();
+    modExp.push_back(Expression{ arena.size(), 0 });
     return true;
 }
 
@@ -236,7 +264,7 @@ std::optional<std::string> ObjectBehaviourLoader::StuffForCreating::inputKeyword
         context = Context::InputingCommand;
         break;
     case LoaderKeyWord::Condition:
-        condExp.emplace_back();
+        condExp.push_back(Expression{ arena.size(), 0 });
         context = Context::InputingConditionExpr;
         break;
     default:
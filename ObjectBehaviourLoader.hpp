@@ -43,8 +43,20 @@ public:
     [[nodiscard]] static std::optional<std::string>
         loadFromStream(std::vector<ObjectBehaviour>& objBehvrs, sf::InputStream& stream, bool endiannessRequired);
 
+    /// Decodes the section in place in one pass: the words are in the host order,
+    /// readCount gets the words of the section (the next section follows)
+    [[nodiscard]] static std::optional<std::string>
+        loadFromMemory(std::vector<ObjectBehaviour>& objBehvrs, const std::uint32_t* data,
+                       std::size_t wordCount, std::size_t& readCount);
+
 private:
 
+    /// The keyword values of the map must be less, so the map is reversed into a dense table
+    static constexpr std::uint32_t KeywordValueLimit = 1 << 16;
+
+    /// The words of the first read of loadFromStream
+    static constexpr std::size_t StreamChunkSize = 1024;
+
     enum class LoaderKeyWord {
         Comma,
         Condition,
@@ -69,8 +81,16 @@ private:
 
         std::vector<ObjectBehaviour> objBehPrep;
 
-        // Object behaviour template to load
-        std::vector<std::vector<std::uint32_t>> condExp, modExp;
+        // An expression of the arena
+        struct Expression {
+            std::size_t first = 0;
+            std::size_t size = 0;
+        };
+
+        // Object behaviour template to load: the expressions of all its conditions
+        // and commands go one by one to the arena, reused by the next behaviour
+        std::vector<std::uint32_t> arena;
+        std::vector<Expression> condExp, modExp;
         std::vector<ObjectCommand> obcommands;
 
         Context context = Context::KeywordExpected;
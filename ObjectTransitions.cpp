@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "ObjectTransitions.hpp"
+#include "ObjectBehaviour.hpp"
+
+namespace {
+
+using namespace CrazySnakes;
+
+std::uint32_t getParamCount(ObjectParameterType type) noexcept {
+    switch (type) {
+    case ObjectParameterType::Acceleration:
+        return AccelerationCount;
+    case ObjectParameterType::Direction:
+        return DirectionCount;
+    case ObjectParameterType::DoubleDirection:
+        return DoubleDirectionCount;
+    case ObjectParameterType::CombinedDirection:
+        return CombinedTubeCount;
+    default:
+        return 1; // the parameter isn't read
+    }
+}
+
+}
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ObjectTransitions::build(const std::vector<ObjectBehaviour>& behaviours) {
+    m_outcomes.assign(behaviours.size() * BehaviourStride, 0);
+    m_paramCounts.assign(behaviours.size(), 0);
+
+    for (std::size_t b = 0; b < behaviours.size(); ++b) {
+        const ObjectBehaviour& behaviour = behaviours[b];
+        if (behaviour.getProperty(ObjectProperty::RequiresRandom))
+            continue;
+
+        std::uint32_t paramCount = getParamCount(behaviour.getParameterType());
+        m_paramCounts[b] = paramCount;
+
+        for (std::uint32_t param = 0; param < paramCount; ++param) {
+            for (std::uint32_t memory = 0; memory < MemoryLimit; ++memory) {
+                std::uint16_t* outcomes = m_outcomes.data() + b * BehaviourStride +
+                    ((std::size_t)param * MemoryLimit + memory) * InputCount;
+
+                for (int p = 0; p <= DirectionCount; ++p) {
+                    for (int d = 0; d < DirectionCount; ++d) {
+                        for (int a = 0; a < AccelerationCount; ++a) {
+                            ObjectBehaviour::ExecutionArguments arguments;
+                            arguments.parameter = param;
+                            arguments.previousSnakeDirection = (Direction)p;
+
+                            ObjectBehaviour::ExecutionTarget target{};
+                            target.remembered = memory;
+                            target.alive = true;
+                            target.moving = true;
+                            target.snakeAcceleration = (Acceleration)a;
+                            target.snakeDirection = (Direction)d;
+
+                            behaviour.activate(target, arguments);
+
+                            // the next visit must be in the table too
+                            if (target.remembered >= MemoryLimit ||
+                                (int)target.snakeDirection >= DirectionCount ||
+                                (int)target.snakeAcceleration >= AccelerationCount)
+                                continue;
+
+                            std::uint16_t packed = KnownBit;
+                            packed |= (std::uint16_t)((std::uint16_t)target.snakeDirection << DirectionShift);
+                            packed |= (std::uint16_t)((std::uint16_t)target.snakeAcceleration << AccelerationShift);
+                            packed |= (std::uint16_t)(target.remembered << RememberedShift);
+                            if (!target.alive)
+                                packed |= KillsBit;
+                            if (!target.moving)
+                                packed |= StopsBit;
+
+                            outcomes[getInputIndex((Direction)p, (Direction)d, (Acceleration)a)] = packed;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace CrazySnakes
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef OBJECT_TRANSITIONS_HPP
+#define OBJECT_TRANSITIONS_HPP
+#include "ObjectParameterEnums.hpp"
+#include "ObjectEnums.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+class ObjectBehaviour;
+
+/// The outcomes of the object behaviours (see ObjectBehaviour::activate) computed once
+/// for every input they can depend on: the parameter, the remembered value,
+/// the previous snake direction, the snake direction and the acceleration.
+/// So the snake can be predicted through the objects without running their programs.
+/// The random behaviours, the parameters out of their types and the remembered values
+/// from MemoryLimit on are not in the table.
+class ObjectTransitions {
+public:
+
+    static constexpr std::uint32_t ParamLimit = DoubleDirectionCount; // the widest parameter type
+    static constexpr std::uint32_t MemoryLimit = 4;
+
+    struct Outcome {
+        Direction snakeDirection = Direction::Count;
+        Acceleration snakeAcceleration = Acceleration::Default;
+        std::uint32_t remembered = 0;
+        bool kills = false;
+        bool stops = false;
+    };
+
+    enum class Lookup {
+        Known,
+        Random,  // the behaviour requires random
+        Unknown  // the parameter or the remembered value is out of the table
+    };
+
+    // behaviours: all the behaviours of the game data (the indices of the pairs refer to them)
+    void build(const std::vector<ObjectBehaviour>& behaviours);
+
+    // previousDirection: Direction::Count before the first step;
+    // inline, it's on the path of every step (see GameImpl::move)
+    Lookup find(std::uint32_t behaviourIndex, std::uint32_t param, std::uint32_t remembered,
+                Direction previousDirection, Direction snakeDirection, Acceleration acceleration,
+                Outcome& outcome) const noexcept;
+
+private:
+
+    // an outcome in 16 bits, 0 if unknown
+    enum PackedBits : std::uint16_t {
+        KnownBit = 1,
+        DirectionShift = 1,
+        AccelerationShift = 3,
+        KillsBit = 1 << 5,
+        StopsBit = 1 << 6,
+        RememberedShift = 7
+    };
+
+    static constexpr std::size_t InputCount = (std::size_t)(DirectionCount + 1) * DirectionCount * AccelerationCount;
+    static constexpr std::size_t BehaviourStride = (std::size_t)ParamLimit * MemoryLimit * InputCount;
+
+    static std::size_t getInputIndex(Direction previousDirection, Direction snakeDirection,
+                                     Acceleration acceleration) noexcept {
+        return ((std::size_t)previousDirection * DirectionCount + (std::size_t)snakeDirection) *
+            AccelerationCount + (std::size_t)acceleration;
+    }
+
+    std::vector<std::uint16_t> m_outcomes; // by the behaviour, the parameter, the remembered value and the input
+    std::vector<std::uint32_t> m_paramCounts; // by the behaviour, 0 if random
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+inline ObjectTransitions::Lookup ObjectTransitions::find(std::uint32_t behaviourIndex, std::uint32_t param,
+                                                         std::uint32_t remembered, Direction previousDirection,
+                                                         Direction snakeDirection, Acceleration acceleration,
+                                                         Outcome& outcome) const noexcept {
+    std::uint32_t paramCount = m_paramCounts[behaviourIndex];
+    if (!paramCount)
+        return Lookup::Random;
+
+    if (paramCount == 1)
+        param = 0;
+
+    if (param >= paramCount || remembered >= MemoryLimit || snakeDirection == Direction::Count)
+        return Lookup::Unknown;
+
+    std::uint16_t packed = m_outcomes[behaviourIndex * BehaviourStride +
+        ((std::size_t)param * MemoryLimit + remembered) * InputCount +
+        getInputIndex(previousDirection, snakeDirection, acceleration)];
+
+    if (!(packed & KnownBit))
+        return Lookup::Unknown;
+
+    outcome.snakeDirection = (Direction)((packed >> DirectionShift) & 3);
+    outcome.snakeAcceleration = (Acceleration)((packed >> AccelerationShift) & 3);
+    outcome.remembered = (std::uint32_t)(packed >> RememberedShift) & (MemoryLimit - 1);
+    outcome.kills = (packed & KillsBit) != 0;
+    outcome.stops = (packed & StopsBit) != 0;
+    return Lookup::Known;
+}
+
+} // namespace CrazySnakes
+
+#endif // !OBJECT_TRANSITIONS_HPP
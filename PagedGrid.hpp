@@ -0,0 +1,396 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef PAGED_GRID_HPP
+#define PAGED_GRID_HPP
+#include "Constants.hpp"
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+// Per-cell values of a map.
+// The maps of TriggerMapSize cells and more are split into square tiles:
+// a tile is allocated on the first change and released as soon as
+// all its cells get back to the initial values, so huge levels cost
+// as much memory as the region really visited. The released tiles are pooled
+// for the next allocations, so a snake going back and forth doesn't hit the heap.
+// Smaller maps are stored as a whole.
+// The changed cells (tiles if paged) are journaled, so restoring costs as much as the changes.
+// Apart from that, the previous values can be logged to roll the changes back (see undo).
+template<class T>
+class PagedGrid {
+public:
+
+	static constexpr unsigned int TileShift = 6;
+	static constexpr int TileSide = 1 << TileShift;
+	static constexpr std::size_t TileArea = (std::size_t)TileSide * TileSide;
+
+	// initial: the initial values (row-major), a dependency; if null, all the cells are 'fill'
+	void reset(const sf::Vector2u& size, const T* initial, const T& fill = T());
+
+	// all the cells back to the initial values
+	void restore();
+
+	// Not paged: so many cells changed that restoring copies all the cells
+	bool isMostlyChanged() const noexcept {
+		return !m_paged && m_journal.size() > m_cells.size() / RestoreCopyRatio;
+	}
+
+	// Calls f(x, y) for the cells that may differ from the initial values since
+	// the last reset or restore. The grid must not be changed meanwhile.
+	template<class F>
+	void forEachChanged(F&& f) const;
+
+	// While logged, every set keeps the previous value, off drops the log.
+	// Restoring or resetting drops the log too.
+	void setUndoLogged(bool logged);
+
+	std::size_t getUndoMark() const noexcept {
+		return m_undoLog.size();
+	}
+
+	// back to the values at the mark, costs as much as the sets since then
+	void undo(std::size_t mark);
+
+	void clearUndo() noexcept {
+		m_undoLog.clear();
+	}
+
+	const T& get(int x, int y) const noexcept;
+	void set(int x, int y, const T& value);
+
+	const T& getInitial(int x, int y) const noexcept {
+		return m_initial ? m_initial[x + (std::size_t)y * m_size.x] : m_fill;
+	}
+
+	const T* getInitialData() const noexcept {
+		return m_initial;
+	}
+
+	bool isPaged() const noexcept {
+		return m_paged;
+	}
+
+	const sf::Vector2u& getSize() const noexcept {
+		return m_size;
+	}
+
+	// tiles by the axes (paged only)
+	const sf::Vector2u& getTileCount() const noexcept {
+		return m_tileCount;
+	}
+
+	std::size_t getTileIndex(int x, int y) const noexcept {
+		return (std::size_t)(x >> TileShift) + (std::size_t)(y >> TileShift) * m_tileCount.x;
+	}
+
+	// row-major values of the tile (TileSide wide) or nullptr if it's not allocated (paged only)
+	const T* getTile(std::size_t tileIndex) const noexcept {
+		return m_tiles[tileIndex].empty() ? nullptr : m_tiles[tileIndex].data();
+	}
+
+	// all the cells, row-major (not paged only)
+	const T* getCells() const noexcept {
+		return m_cells.data();
+	}
+
+	// the cell in its tile
+	static std::size_t getTileOffset(int x, int y) noexcept {
+		return (std::size_t)(x & (TileSide - 1)) + ((std::size_t)(y & (TileSide - 1)) << TileShift);
+	}
+
+	std::size_t getAllocatedTileCount() const noexcept {
+		return m_allocatedTileCount;
+	}
+
+private:
+
+	static constexpr std::size_t RestoreCopyRatio = 8;
+
+	void allocateTile(std::size_t tileIndex);
+	void releaseTile(std::size_t tileIndex) noexcept;
+
+	struct UndoEntry {
+		int x;
+		int y;
+		T value;
+	};
+
+	// reserved for every cell (tile if paged) in reset, so it doesn't allocate
+	void journal(std::size_t index) noexcept {
+		if (!m_journaled[index]) {
+			m_journaled[index] = 1;
+			m_journal.push_back((std::uint32_t)index);
+		}
+	}
+
+	std::vector<T> m_cells;                     // Not paged: all the cells
+	std::vector<std::vector<T>> m_tiles;        // Paged: empty if not allocated
+	std::vector<std::vector<T>> m_freeTiles;    // Paged: released, at most a tile per map tile
+	std::vector<std::uint32_t> m_changedCounts; // Paged: cells differing from the initial ones
+	std::vector<std::uint32_t> m_journal;       // Changed cells or tiles if paged, in order
+	std::vector<std::uint8_t> m_journaled;
+	std::vector<UndoEntry> m_undoLog;           // Previous values, in order
+	const T* m_initial = nullptr;               // Dependency
+	T m_fill{};
+	sf::Vector2u m_size;
+	sf::Vector2u m_tileCount;
+	std::size_t m_allocatedTileCount = 0;
+	bool m_paged = false;
+	bool m_undoLogged = false;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void PagedGrid<T>::reset(const sf::Vector2u& size, const T* initial, const T& fill) {
+	m_size = size;
+	m_initial = initial;
+	m_fill = fill;
+	m_paged = (std::size_t)size.x * size.y >= TriggerMapSize;
+
+	m_journal.clear();
+	m_undoLog.clear();
+
+	if (m_paged) {
+		std::vector<T>().swap(m_cells);
+		m_tileCount.x = (size.x + TileSide - 1) >> TileShift;
+		m_tileCount.y = (size.y + TileSide - 1) >> TileShift;
+
+		std::size_t tileCount = (std::size_t)m_tileCount.x * m_tileCount.y;
+
+		// the tiles in use and pooled never outnumber the map tiles, so releasing doesn't allocate
+		for (auto& tile : m_tiles) {
+			if (!tile.empty() && m_freeTiles.size() < tileCount) {
+				m_freeTiles.emplace_back();
+				m_freeTiles.back().swap(tile);
+			}
+		}
+		if (m_freeTiles.size() > tileCount)
+			m_freeTiles.resize(tileCount);
+		m_freeTiles.reserve(tileCount);
+
+		m_tiles.clear();
+		m_tiles.resize(tileCount);
+		m_changedCounts.assign(m_tiles.size(), 0);
+		m_journaled.assign(m_tiles.size(), 0);
+		m_journal.reserve(m_tiles.size());
+		m_allocatedTileCount = 0;
+	} else {
+		std::vector<std::vector<T>>().swap(m_tiles);
+		std::vector<std::vector<T>>().swap(m_freeTiles);
+		std::vector<std::uint32_t>().swap(m_changedCounts);
+		m_tileCount = sf::Vector2u();
+		m_allocatedTileCount = 0;
+
+		std::size_t area = (std::size_t)size.x * size.y;
+		if (m_initial)
+			m_cells.assign(m_initial, m_initial + area);
+		else
+			m_cells.assign(area, m_fill);
+		m_journaled.assign(area, 0);
+		m_journal.reserve(area);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void PagedGrid<T>::restore() {
+	m_undoLog.clear();
+
+	if (isMostlyChanged()) {
+		if (m_initial)
+			std::copy(m_initial, m_initial + m_cells.size(), m_cells.begin());
+		else
+			std::fill(m_cells.begin(), m_cells.end(), m_fill);
+
+		std::fill(m_journaled.begin(), m_journaled.end(), 0);
+		m_journal.clear();
+		return;
+	}
+
+	for (std::size_t index : m_journal) {
+		m_journaled[index] = 0;
+
+		if (!m_paged) {
+			m_cells[index] = m_initial ? m_initial[index] : m_fill;
+		} else if (!m_tiles[index].empty()) {
+			releaseTile(index);
+			m_changedCounts[index] = 0;
+		}
+	}
+
+	m_journal.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+template<class F>
+void PagedGrid<T>::forEachChanged(F&& f) const {
+	for (std::size_t index : m_journal) {
+		if (!m_paged) {
+			f(int(index % m_size.x), int(index / m_size.x));
+			continue;
+		}
+
+		const std::vector<T>& tile = m_tiles[index];
+		if (tile.empty())
+			continue;
+
+		int left = int(index % m_tileCount.x) << TileShift;
+		int top = int(index / m_tileCount.x) << TileShift;
+		int right = std::min(left + TileSide, (int)m_size.x);
+		int bottom = std::min(top + TileSide, (int)m_size.y);
+
+		for (int y = top; y < bottom; ++y) {
+			for (int x = left; x < right; ++x) {
+				if (!(tile[getTileOffset(x, y)] == getInitial(x, y)))
+					f(x, y);
+			}
+		}
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void PagedGrid<T>::setUndoLogged(bool logged) {
+	m_undoLogged = logged;
+	if (!logged)
+		std::vector<UndoEntry>().swap(m_undoLog);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void PagedGrid<T>::undo(std::size_t mark) {
+	assert(mark <= m_undoLog.size());
+
+	bool logged = m_undoLogged;
+	m_undoLogged = false;
+
+	while (m_undoLog.size() > mark) {
+		const UndoEntry& entry = m_undoLog.back();
+		set(entry.x, entry.y, entry.value);
+		m_undoLog.pop_back();
+	}
+
+	m_undoLogged = logged;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+const T& PagedGrid<T>::get(int x, int y) const noexcept {
+	if (!m_paged)
+		return m_cells[x + (std::size_t)y * m_size.x];
+
+	const std::vector<T>& tile = m_tiles[getTileIndex(x, y)];
+	return tile.empty() ? getInitial(x, y) : tile[getTileOffset(x, y)];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void PagedGrid<T>::set(int x, int y, const T& value) {
+	if (m_undoLogged)
+		m_undoLog.push_back(UndoEntry{ x, y, get(x, y) });
+
+	if (!m_paged) {
+		std::size_t index = x + (std::size_t)y * m_size.x;
+		m_cells[index] = value;
+		journal(index);
+		return;
+	}
+
+	std::size_t tileIndex = getTileIndex(x, y);
+	const T& initial = getInitial(x, y);
+
+	if (m_tiles[tileIndex].empty()) {
+		if (value == initial)
+			return;
+		allocateTile(tileIndex);
+	}
+
+	T& cell = m_tiles[tileIndex][getTileOffset(x, y)];
+	bool wasChanged = !(cell == initial);
+	bool isChanged = !(value == initial);
+	cell = value;
+
+	if (isChanged == wasChanged)
+		return;
+
+	if (isChanged) {
+		++m_changedCounts[tileIndex];
+	} else if (!--m_changedCounts[tileIndex]) {
+		releaseTile(tileIndex);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void PagedGrid<T>::allocateTile(std::size_t tileIndex) {
+	std::vector<T>& tile = m_tiles[tileIndex];
+	if (!m_freeTiles.empty()) {
+		tile.swap(m_freeTiles.back());
+		m_freeTiles.pop_back();
+	}
+	tile.assign(TileArea, m_fill);
+
+	int left = int(tileIndex % m_tileCount.x) << TileShift;
+	int top = int(tileIndex / m_tileCount.x) << TileShift;
+	int right = std::min(left + TileSide, (int)m_size.x);
+	int bottom = std::min(top + TileSide, (int)m_size.y);
+
+	if (m_initial) {
+		for (int y = top; y < bottom; ++y) {
+			const T* row = m_initial + (std::size_t)y * m_size.x;
+			std::copy(row + left, row + right, tile.data() + getTileOffset(0, y));
+		}
+	}
+
+	++m_allocatedTileCount;
+	journal(tileIndex);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void PagedGrid<T>::releaseTile(std::size_t tileIndex) noexcept {
+	m_freeTiles.emplace_back();
+	m_freeTiles.back().swap(m_tiles[tileIndex]);
+	--m_allocatedTileCount;
+}
+
+} // namespace CrazySnakes
+
+#endif // !PAGED_GRID_HPP
@@ -23,21 +23,43 @@
 //
 ////////////////////////////////////////////////////////////
 
-#include "RandomizerImpl.hpp"
+#include "Randomizer.hpp"
 
 namespace CrazySnakes {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-RandomizerImpl::RandomizerImpl() {}
+void Randomizer::setSeed(std::uint64_t seed, std::uint64_t stream) noexcept {
+    // splitmix64 spreads the seed over the state, never all zeros
+    for (auto& word : m_state) {
+        std::uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        word = z ^ (z >> 31);
+    }
 
-void RandomizerImpl::setSeed(std::uint64_t seed) {
-    m_gen.seed(seed);
-    m_gen.discard(3);
+    for (std::uint64_t i = 0; i < stream; ++i)
+        jump();
 }
 
-std::uint64_t RandomizerImpl::get(std::uint64_t least, std::uint64_t greatest) {
-    std::uniform_int_distribution<std::uint64_t> distr(least, greatest);
-    return distr(m_gen);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void Randomizer::jump() noexcept {
+    static constexpr std::uint64_t Polynomial[] = {
+        0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+    };
+
+    std::array<std::uint64_t, 4> state{};
+    for (std::uint64_t word : Polynomial) {
+        for (int bit = 0; bit < 64; ++bit) {
+            if (word & ((std::uint64_t)1 << bit)) {
+                for (std::size_t i = 0; i < state.size(); ++i)
+                    state[i] ^= m_state[i];
+            }
+            (void)next();
+        }
+    }
+
+    m_state = state;
 }
 
-}
\ No newline at end of file
+}
@@ -23,21 +23,126 @@
 //
 ////////////////////////////////////////////////////////////
 
+
 #ifndef RANDOMIZER_HPP
 #define RANDOMIZER_HPP
+#include "MiscEnum.hpp"
+#include <array>
 #include <cstdint>
 
 namespace CrazySnakes {
 
+// xoshiro256** generator, 2^256 - 1 period.
+// Not virtual and drawing is inline, so a number costs a few instructions where it's drawn.
+// The same seed and stream give the same numbers on every platform.
 class Randomizer {
 public:
 
-	[[nodiscard]] virtual std::uint64_t get(std::uint64_t least, std::uint64_t greatest) = 0;
+    Randomizer() noexcept {
+        setSeed(0);
+    }
+
+    // stream: the numbers of the seed are split into streams 2^128 apart (see jump),
+    // so the generators of one seed and different streams never overlap
+    void setSeed(std::uint64_t seed, std::uint64_t stream = 0) noexcept;
+
+    // uniform in [least, greatest], unbiased
+    [[nodiscard]] std::uint64_t get(std::uint64_t least, std::uint64_t greatest) noexcept;
+
+    [[nodiscard]] std::uint64_t next() noexcept;
+
+    // 2^128 numbers forward
+    void jump() noexcept;
+
+    // equal states draw the same numbers
+    const std::array<std::uint64_t, 4>& getState() const noexcept {
+        return m_state;
+    }
+
+private:
 
-	virtual ~Randomizer() noexcept {}
+    static std::uint64_t rotateLeft(std::uint64_t value, int shift) noexcept {
+        return (value << shift) | (value >> (64 - shift));
+    }
 
+    std::array<std::uint64_t, 4> m_state{};
 };
 
+
+// The randomizers of all the types, the streams of one seed:
+// drawing for one type never shifts the numbers of the others.
+class RandomizerSet {
+public:
+
+    // the streams the set takes, the further ones of the seed are free (e.g. for the input)
+    static constexpr std::uint64_t StreamCount = RandomTypeCount;
+
+    RandomizerSet() noexcept {
+        setSeed(0);
+    }
+
+    void setSeed(std::uint64_t seed) noexcept {
+        for (int i = 0; i < RandomTypeCount; ++i)
+            m_randomizers[i].setSeed(seed, (std::uint64_t)i);
+    }
+
+    Randomizer& get(RandomizerType type) noexcept {
+        return m_randomizers[(std::size_t)type];
+    }
+
+    // by the type (see GameImpl), valid while the set isn't moved or copied
+    std::array<Randomizer*, RandomTypeCount> getPointers() noexcept {
+        std::array<Randomizer*, RandomTypeCount> pointers{};
+        for (int i = 0; i < RandomTypeCount; ++i)
+            pointers[i] = &m_randomizers[i];
+        return pointers;
+    }
+
+private:
+
+    std::array<Randomizer, RandomTypeCount> m_randomizers;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+inline std::uint64_t Randomizer::next() noexcept {
+    std::uint64_t result = rotateLeft(m_state[1] * 5, 7) * 9;
+    std::uint64_t shifted = m_state[1] << 17;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= shifted;
+    m_state[3] = rotateLeft(m_state[3], 45);
+
+    return result;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+inline std::uint64_t Randomizer::get(std::uint64_t least, std::uint64_t greatest) noexcept {
+    std::uint64_t range = greatest - least;
+    if (range == UINT64_MAX)
+        return next();
+
+    // the numbers under the least all-ones mask covering the range, the greater ones drawn again
+    std::uint64_t mask = range;
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+    mask |= mask >> 32;
+
+    std::uint64_t value;
+    do {
+        value = next() & mask;
+    } while (value > range);
+
+    return least + value;
+}
+
 } // namespace CrazySnakes
 
 #endif // !RANDOMIZER_HPP
@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "Replay.hpp"
+#include "ObjectParameterEnums.hpp"
+#include "FileOutputStream.hpp"
+#include "Endianness.hpp"
+#include <SFML/System/FileInputStream.hpp>
+#include <algorithm>
+
+namespace {
+
+// "SNRP"
+constexpr std::uint32_t ReplayMagic = 0x534e5250;
+constexpr std::uint32_t ReplayVersion = 3; // 2: a randomizer stream per type, 3: fruits placed at once
+
+// magic, version, difficulty, level, seed (2), end time (2), command count, step count
+constexpr std::size_t HeaderSize = 10;
+
+// time (2), direction
+constexpr std::size_t CommandSize = 3;
+
+std::uint64_t join(std::uint32_t high, std::uint32_t low) noexcept {
+    return (std::uint64_t)high << 32 | low;
+}
+
+}
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void Replay::start(unsigned int difficulty, unsigned int levelIndex, std::uint64_t seed) {
+    m_difficulty = difficulty;
+    m_levelIndex = levelIndex;
+    m_seed = seed;
+    m_endTime = 0;
+    m_commands.clear();
+    m_checksums.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void Replay::addCommand(std::int64_t time, Direction direction) {
+    Command command{};
+    command.time = time;
+    command.direction = direction;
+    m_commands.push_back(command);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void Replay::addStep(std::uint64_t checksum) {
+    m_checksums.push_back(foldChecksum(checksum));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::optional<std::string> Replay::saveToFile(const std::string& path) const {
+    std::vector<std::uint32_t> dataOutput;
+    dataOutput.reserve(HeaderSize + m_commands.size() * CommandSize + m_checksums.size());
+
+    dataOutput.push_back(ReplayMagic);
+    dataOutput.push_back(ReplayVersion);
+    dataOutput.push_back(m_difficulty);
+    dataOutput.push_back(m_levelIndex);
+    dataOutput.push_back((std::uint32_t)(m_seed >> 32));
+    dataOutput.push_back((std::uint32_t)m_seed);
+    dataOutput.push_back((std::uint32_t)((std::uint64_t)m_endTime >> 32));
+    dataOutput.push_back((std::uint32_t)m_endTime);
+    dataOutput.push_back((std::uint32_t)m_commands.size());
+    dataOutput.push_back((std::uint32_t)m_checksums.size());
+
+    for (const auto& command : m_commands) {
+        dataOutput.push_back((std::uint32_t)((std::uint64_t)command.time >> 32));
+        dataOutput.push_back((std::uint32_t)command.time);
+        dataOutput.push_back((std::uint32_t)command.direction);
+    }
+
+    dataOutput.insert(dataOutput.end(), m_checksums.begin(), m_checksums.end());
+
+    // endianness
+    std::for_each(dataOutput.begin(), dataOutput.end(),
+                  [](std::uint32_t& v) {
+                      v = h2nl(v);
+                  });
+
+    FileOutputStream foutp;
+    if (!foutp.open(path))
+        return "Failed to open " + path;
+
+    std::int64_t size = (std::int64_t)dataOutput.size() * 4;
+    if (foutp.write(dataOutput.data(), size) != size)
+        return "Failed to write " + path;
+
+    return std::nullopt;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::optional<std::string> Replay::loadFromFile(const std::string& path) {
+    std::vector<std::uint32_t> dataInput;
+
+    sf::FileInputStream finp;
+    if (!finp.open(path))
+        return "Failed to load " + path;
+
+    sf::Int64 sz = finp.getSize();
+    if (sz % 4 != 0 || sz < (sf::Int64)HeaderSize * 4)
+        return path + ": wrong size";
+
+    dataInput.resize(sz / 4);
+    sf::Int64 read = finp.read(dataInput.data(), sz);
+    if (read != sz)
+        return "Failed to read " + path;
+
+    // endianness
+    std::for_each(dataInput.begin(), dataInput.end(),
+                  [](std::uint32_t& v) {
+                      v = n2hl(v);
+                  });
+
+    if (dataInput[0] != ReplayMagic)
+        return path + " is not a replay";
+    if (dataInput[1] != ReplayVersion)
+        return path + ": unknown version " + std::to_string(dataInput[1]);
+
+    std::size_t commandCount = dataInput[8];
+    std::size_t stepCount = dataInput[9];
+    if (dataInput.size() != HeaderSize + commandCount * CommandSize + stepCount)
+        return path + ": wrong size";
+
+    const std::uint32_t* commandData = dataInput.data() + HeaderSize;
+    std::vector<Command> commands(commandCount);
+
+    for (std::size_t i = 0; i < commandCount; ++i, commandData += CommandSize) {
+        if (commandData[2] >= (std::uint32_t)DirectionCount)
+            return path + " is corrupted: wrong direction";
+
+        commands[i].time = (std::int64_t)join(commandData[0], commandData[1]);
+        commands[i].direction = (Direction)commandData[2];
+    }
+
+    m_difficulty = dataInput[2];
+    m_levelIndex = dataInput[3];
+    m_seed = join(dataInput[4], dataInput[5]);
+    m_endTime = (std::int64_t)join(dataInput[6], dataInput[7]);
+    m_commands.swap(commands);
+    m_checksums.assign(commandData, commandData + stepCount);
+
+    return std::nullopt;
+}
+
+} // namespace CrazySnakes
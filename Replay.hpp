@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+#include <optional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+enum class Direction;
+
+/// One run of a level, enough to play it again headless the same way:
+/// the game randomizers (see RandomizerSet) are seeded for the run,
+/// the commands are as pushed and every step keeps its checksum (see Game::Event)
+/// to find where a playback diverges.
+class Replay {
+public:
+
+    struct Command {
+        std::int64_t time;
+        Direction direction;
+    };
+
+    // a new run, no commands and steps
+    void start(unsigned int difficulty, unsigned int levelIndex, std::uint64_t seed);
+
+    void addCommand(std::int64_t time, Direction direction);
+    void addStep(std::uint64_t checksum);
+
+    // time of the last update
+    void finish(std::int64_t endTime) noexcept {
+        m_endTime = endTime;
+    }
+
+    unsigned int getDifficulty() const noexcept {
+        return m_difficulty;
+    }
+
+    unsigned int getLevelIndex() const noexcept {
+        return m_levelIndex;
+    }
+
+    std::uint64_t getSeed() const noexcept {
+        return m_seed;
+    }
+
+    std::int64_t getEndTime() const noexcept {
+        return m_endTime;
+    }
+
+    const std::vector<Command>& getCommands() const noexcept {
+        return m_commands;
+    }
+
+    // folded to 32 bits
+    const std::vector<std::uint32_t>& getChecksums() const noexcept {
+        return m_checksums;
+    }
+
+    static std::uint32_t foldChecksum(std::uint64_t checksum) noexcept {
+        return (std::uint32_t)(checksum ^ (checksum >> 32));
+    }
+
+    [[nodiscard]] std::optional<std::string> saveToFile(const std::string& path) const;
+    [[nodiscard]] std::optional<std::string> loadFromFile(const std::string& path);
+
+private:
+
+    std::vector<Command> m_commands;
+    std::vector<std::uint32_t> m_checksums;
+    std::uint64_t m_seed = 0;
+    std::int64_t m_endTime = 0;
+    unsigned int m_difficulty = 0;
+    unsigned int m_levelIndex = 0;
+};
+
+} // namespace CrazySnakes
+
+#endif // !REPLAY_HPP
@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef RING_QUEUE_HPP
+#define RING_QUEUE_HPP
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace CrazySnakes {
+
+// FIFO queue in one ring buffer.
+// The capacity is a power of 2 and only grows on overflow (it's kept by clear),
+// so a queue that has warmed up doesn't allocate anymore.
+template<class T>
+class RingQueue {
+public:
+
+    static constexpr std::size_t MinCapacity = 16;
+
+    RingQueue() noexcept = default;
+
+    RingQueue(const RingQueue&) = default;
+    RingQueue(RingQueue&& src) noexcept;
+
+    RingQueue& operator=(const RingQueue&) = default;
+    RingQueue& operator=(RingQueue&& src) noexcept;
+
+    bool empty() const noexcept {
+        return !m_size;
+    }
+
+    std::size_t size() const noexcept {
+        return m_size;
+    }
+
+    const T& front() const noexcept {
+        return m_items[m_begin];
+    }
+
+    void push_back(const T& item);
+    void pop_front() noexcept;
+
+    // pops up to maxCount items to dst, returns their count
+    std::size_t popTo(T* dst, std::size_t maxCount) noexcept;
+
+    // keeps the capacity
+    void clear() noexcept;
+
+private:
+
+    void grow();
+
+    std::vector<T> m_items; // the capacity
+    std::size_t m_begin = 0;
+    std::size_t m_size = 0;
+};
+
+template<class T>
+inline RingQueue<T>::RingQueue(RingQueue&& src) noexcept :
+    m_items(std::move(src.m_items)),
+    m_begin(src.m_begin),
+    m_size(src.m_size) {
+    src.m_begin = 0;
+    src.m_size = 0;
+}
+
+template<class T>
+inline RingQueue<T>& RingQueue<T>::operator=(RingQueue&& src) noexcept {
+    if (this == &src)
+        return *this;
+
+    m_items = std::move(src.m_items);
+    m_begin = src.m_begin;
+    m_size = src.m_size;
+
+    src.m_items.clear();
+    src.m_begin = 0;
+    src.m_size = 0;
+
+    return *this;
+}
+
+template<class T>
+inline void RingQueue<T>::push_back(const T& item) {
+    if (m_size == m_items.size())
+        grow();
+
+    m_items[(m_begin + m_size) & (m_items.size() - 1)] = item;
+    ++m_size;
+}
+
+template<class T>
+inline void RingQueue<T>::pop_front() noexcept {
+    m_begin = (m_begin + 1) & (m_items.size() - 1);
+    --m_size;
+}
+
+template<class T>
+inline std::size_t RingQueue<T>::popTo(T* dst, std::size_t maxCount) noexcept {
+    std::size_t count = (maxCount < m_size ? maxCount : m_size);
+
+    for (std::size_t i = 0; i < count; ++i)
+        dst[i] = m_items[(m_begin + i) & (m_items.size() - 1)];
+
+    if (count) {
+        m_begin = (m_begin + count) & (m_items.size() - 1);
+        m_size -= count;
+    }
+
+    return count;
+}
+
+template<class T>
+inline void RingQueue<T>::clear() noexcept {
+    m_begin = 0;
+    m_size = 0;
+}
+
+template<class T>
+void RingQueue<T>::grow() {
+    std::vector<T> items(m_items.empty() ? MinCapacity : m_items.size() * 2);
+
+    for (std::size_t i = 0; i < m_size; ++i)
+        items[i] = m_items[(m_begin + i) & (m_items.size() - 1)];
+
+    m_items.swap(items);
+    m_begin = 0;
+}
+
+}
+
+#endif // !RING_QUEUE_HPP
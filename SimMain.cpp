@@ -0,0 +1,630 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#include "GameData.hpp"
+#include "Game.hpp"
+#include "Randomizer.hpp"
+#include "AttribEnums.hpp"
+#include "FilePaths.hpp"
+#include "Constants.hpp"
+#include "Replay.hpp"
+#include "BatchRunner.hpp"
+#include "Autopilot.hpp"
+#include "VectorEnvironment.hpp"
+#include "BehaviourProfiler.hpp"
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Headless simulation runner (no window, no audio).
+// Plays the level as fast as possible and measures the engine throughput,
+// or plays a recorded replay back to reproduce it,
+// or plays the levels on all the cores and prints their statistics (-t),
+// or lets the autopilot play for the given time (-a, a soak test),
+// or steps many games together as the learning environment does (-e).
+
+namespace {
+
+using namespace CrazySnakes;
+
+struct Options {
+    std::string dataPath = DATA_PATH;
+    std::string scriptPath;
+    std::string replayPath;
+    std::string recordPath;
+    std::string checksumPath;
+    unsigned int diffCount = 3;
+    unsigned int levelCount = 12;
+    unsigned int difficulty = 0;
+    unsigned int levelIndex = 0;
+    unsigned int gameCount = 100;
+    std::uint64_t seed = 0;
+    std::int64_t commandPeriod = 0; // 0 means the snake period
+    bool batch = false;
+    unsigned int threadCount = 0;   // 0 means all the cores
+    bool allDifficulties = false;   // batch only
+    bool allLevels = false;         // batch only
+    bool autopilot = false;
+    std::uintmax_t soakSeconds = 0; // autopilot: play until then instead of the game count
+    std::size_t environmentSize = 0; // games stepped together, 0 means none
+};
+
+struct ScriptCommand {
+    std::int64_t time;
+    Direction direction;
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: snatan-sim [options]\n"
+        "  -f <path>   data file (default: Resources/data.bin)\n"
+        "  -D <count>  difficulty count in the data file (default: 3)\n"
+        "  -L <count>  level count in the data file (default: 12)\n"
+        "  -d <index>  difficulty to play, 'all' in a batch (default: 0)\n"
+        "  -l <index>  level to play, 'all' in a batch (default: 0)\n"
+        "  -g <count>  games to play (default: 100)\n"
+        "  -s <seed>   random seed (default: 0)\n"
+        "  -p <mcs>    period of random commands (default: snake period)\n"
+        "  -i <path>   scripted commands, one '<time mcs> <U|R|D|L>' per line\n"
+        "  -r <path>   play the replay (its level, once) and check the step checksums\n"
+        "  -w <path>   record the last game to the replay\n"
+        "  -c <path>   save the step checksums of the last game, one per line\n"
+        "  -t <count>  batch on the threads (0: all the cores), prints the level statistics\n"
+        "  -a <secs>   the autopilot plays instead of random commands, for the seconds (0: the game count)\n"
+        "  -e <count>  the games stepped together by random actions as the learning environment does\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strlen(argv[i]) != 2 || argv[i][0] != '-' || i + 1 >= argc)
+            return false;
+
+        const char* value = argv[++i];
+
+        switch (argv[i - 1][1]) {
+        case 'f':
+            options.dataPath = value;
+            break;
+        case 'i':
+            options.scriptPath = value;
+            break;
+        case 'r':
+            options.replayPath = value;
+            break;
+        case 'w':
+            options.recordPath = value;
+            break;
+        case 'c':
+            options.checksumPath = value;
+            break;
+        case 'D':
+            options.diffCount = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 'L':
+            options.levelCount = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 'd':
+            options.allDifficulties = !std::strcmp(value, "all");
+            options.difficulty = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 'l':
+            options.allLevels = !std::strcmp(value, "all");
+            options.levelIndex = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 't':
+            options.batch = true;
+            options.threadCount = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 'g':
+            options.gameCount = (unsigned int)std::strtoul(value, nullptr, 10);
+            break;
+        case 's':
+            options.seed = std::strtoull(value, nullptr, 10);
+            break;
+        case 'p':
+            options.commandPeriod = std::strtoll(value, nullptr, 10);
+            break;
+        case 'a':
+            options.autopilot = true;
+            options.soakSeconds = std::strtoull(value, nullptr, 10);
+            break;
+        case 'e':
+            options.environmentSize = (std::size_t)std::strtoull(value, nullptr, 10);
+            if (!options.environmentSize)
+                return false;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+bool loadScript(const std::string& path, std::vector<ScriptCommand>& script) {
+    std::ifstream fin(path);
+    if (!fin)
+        return false;
+
+    std::int64_t time;
+    char dirChar;
+    while (fin >> time >> dirChar) {
+        ScriptCommand command{};
+        command.time = time;
+
+        switch (dirChar) {
+        case 'U':
+            command.direction = Direction::Up;
+            break;
+        case 'R':
+            command.direction = Direction::Right;
+            break;
+        case 'D':
+            command.direction = Direction::Down;
+            break;
+        case 'L':
+            command.direction = Direction::Left;
+            break;
+        default:
+            return false;
+        }
+
+        script.push_back(command);
+    }
+
+    return fin.eof();
+}
+
+bool saveChecksums(const std::string& path, const std::vector<std::uint64_t>& checksums) {
+    std::ofstream fout(path);
+    for (std::uint64_t checksum : checksums)
+        fout << std::hex << std::setw(16) << std::setfill('0') << checksum << '\n';
+    return (bool)fout;
+}
+
+// the costs of the objects, if the profiler is built in (see BehaviourProfiler)
+void printBehaviourProfile() {
+    if constexpr (BehaviourProfiler::Enabled) {
+        std::cout << '\n';
+        BehaviourProfiler::print(std::cout);
+    }
+}
+
+
+int runBatch(const Options& options, const GameData& gameData) {
+    std::vector<BatchRunner::Job> jobs;
+
+    for (unsigned int d = 0; d < options.diffCount; ++d) {
+        for (unsigned int l = 0; l < options.levelCount; ++l) {
+            if ((options.allDifficulties || d == options.difficulty) &&
+                (options.allLevels || l == options.levelIndex))
+                jobs.push_back(BatchRunner::Job{ d, l, options.gameCount });
+        }
+    }
+
+    BatchRunner::Options batchOptions;
+    batchOptions.threadCount = options.threadCount;
+    batchOptions.seed = options.seed;
+    batchOptions.commandPeriod = options.commandPeriod;
+
+    // the workers have ended, so the profile is of the level only
+    if constexpr (BehaviourProfiler::Enabled) {
+        batchOptions.levelEnded = [](const BatchRunner::Report& report) {
+            std::cout << "difficulty " << report.difficulty << ", level " << report.levelIndex << ":\n";
+            BehaviourProfiler::print(std::cout);
+            std::cout << '\n';
+            BehaviourProfiler::reset();
+        };
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<BatchRunner::Report> reports = BatchRunner(gameData).run(jobs, batchOptions);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+    std::cout << "diff level   games  done %  steps/done  steps/game  object    tail    time   other\n";
+
+    std::uintmax_t gameCount = 0;
+    for (const auto& report : reports) {
+        const auto& deaths = report.deathCounts;
+
+        std::cout << std::setw(4) << report.difficulty << std::setw(6) << report.levelIndex
+            << std::setw(8) << report.gameCount
+            << std::setw(8) << std::fixed << std::setprecision(1) << report.getCompletionRate() * 100
+            << std::setw(12) << report.getAverageCompletionSteps()
+            << std::setw(12) << report.getAverageSteps()
+            << std::setw(8) << deaths[(int)DeathCause::Object]
+            << std::setw(8) << deaths[(int)DeathCause::Tail]
+            << std::setw(8) << deaths[(int)DeathCause::TimeLimit]
+            << std::setw(8) << deaths[(int)DeathCause::NoDeath] + deaths[(int)DeathCause::Killed] << '\n';
+
+        gameCount += report.gameCount;
+    }
+
+    std::cout << std::defaultfloat << std::setprecision(6) << gameCount << " games, time: " << elapsed.count() << " s\n";
+    return EXIT_SUCCESS;
+}
+
+// Until the games finished reach the game count
+int runEnvironment(const Options& options, const GameData& gameData) {
+    LevelSetup levelSetup;
+    levelSetup.create(gameData, options.difficulty, options.levelIndex);
+
+    VectorEnvironment::Options environmentOptions;
+    environmentOptions.gameCount = options.environmentSize;
+    environmentOptions.seed = options.seed;
+
+    VectorEnvironment environment;
+    environment.reset(levelSetup, environmentOptions);
+
+    std::size_t size = environment.getGameCount();
+    std::vector<std::uint8_t> observations(size * environment.getObservationSize());
+    std::vector<std::uint32_t> actions(size);
+    std::vector<float> rewards(size);
+    std::vector<std::uint8_t> dones(size);
+
+    Randomizer inputRandomizer;
+    inputRandomizer.setSeed(options.seed, RandomizerSet::StreamCount);
+
+    auto started = std::chrono::steady_clock::now();
+    environment.restart(observations.data());
+
+    std::uintmax_t stepCount = 0;
+    std::uintmax_t finishedCount = 0;
+    double score = 0;
+
+    while (finishedCount < options.gameCount) {
+        for (auto& action : actions)
+            action = (std::uint32_t)inputRandomizer.get(0, DirectionCount - 1);
+
+        environment.step(actions.data(), observations.data(), rewards.data(), dones.data());
+
+        stepCount += size;
+        for (std::size_t i = 0; i < size; ++i) {
+            score += rewards[i];
+            finishedCount += dones[i];
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    double seconds = elapsed.count();
+
+    std::cout << "difficulty " << options.difficulty << ", level " << options.levelIndex
+        << " (" << levelSetup.getMapSize().x << 'x' << levelSetup.getMapSize().y << "), "
+        << size << " games together, window " << environment.getWindowSize().x << 'x'
+        << environment.getWindowSize().y << '\n';
+    std::cout << "steps: " << stepCount << ", games finished: " << finishedCount
+        << ", score/game: " << score / (double)finishedCount << ", time: " << seconds << " s\n";
+
+    if (seconds > 0)
+        std::cout << "steps/sec: " << (double)stepCount / seconds << '\n';
+
+    printBehaviourProfile();
+    return EXIT_SUCCESS;
+}
+
+// the first step with another checksum or the count of the steps played
+std::size_t findDivergence(const Replay& replay, const std::vector<std::uint64_t>& checksums) {
+    const auto& recorded = replay.getChecksums();
+
+    for (std::size_t i = 0; i < checksums.size(); ++i) {
+        if (i >= recorded.size() || Replay::foldChecksum(checksums[i]) != recorded[i])
+            return i;
+    }
+    return checksums.size();
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    if (!options.replayPath.empty() && (!options.scriptPath.empty() || !options.recordPath.empty())) {
+        std::cerr << "A replay is played alone\n";
+        return EXIT_FAILURE;
+    }
+
+    if (options.autopilot && (options.batch || !options.replayPath.empty() || !options.scriptPath.empty())) {
+        std::cerr << "The autopilot plays alone\n";
+        return EXIT_FAILURE;
+    }
+
+    if (options.environmentSize && (options.batch || options.autopilot || !options.replayPath.empty() ||
+                                    !options.scriptPath.empty() || !options.recordPath.empty() ||
+                                    !options.checksumPath.empty())) {
+        std::cerr << "The environment plays random actions alone\n";
+        return EXIT_FAILURE;
+    }
+
+    if (options.batch && (!options.replayPath.empty() || !options.scriptPath.empty() ||
+                          !options.recordPath.empty() || !options.checksumPath.empty())) {
+        std::cerr << "A batch plays random commands only\n";
+        return EXIT_FAILURE;
+    }
+
+    if ((options.allDifficulties || options.allLevels) && !options.batch) {
+        std::cerr << "All the levels are played in a batch only\n";
+        return EXIT_FAILURE;
+    }
+
+    Replay replay;
+    if (!options.replayPath.empty()) {
+        auto replayLog{ replay.loadFromFile(options.replayPath) };
+        if (replayLog) {
+            std::cerr << *replayLog << '\n';
+            return EXIT_FAILURE;
+        }
+
+        options.difficulty = replay.getDifficulty();
+        options.levelIndex = replay.getLevelIndex();
+        options.gameCount = 1;
+    }
+
+    // after the replay, which has its own level
+    if (options.diffCount < DiffCountMin || options.diffCount > DiffCountMax ||
+        options.levelCount < LevelCountMin || options.levelCount > LevelCountMax ||
+        (!options.allDifficulties && options.difficulty >= options.diffCount) ||
+        (!options.allLevels && options.levelIndex >= options.levelCount)) {
+        std::cerr << "Wrong difficulty or level\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<ScriptCommand> script;
+    if (!options.scriptPath.empty() && !loadScript(options.scriptPath, script)) {
+        std::cerr << "Failed to load " << options.scriptPath << '\n';
+        return EXIT_FAILURE;
+    }
+
+    GameData gameData;
+    auto dataLog{ gameData.loadFromFile(options.dataPath, options.diffCount, options.levelCount) };
+    if (dataLog) {
+        std::cerr << *dataLog << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (options.batch)
+        return runBatch(options, gameData);
+
+    if (options.environmentSize)
+        return runEnvironment(options, gameData);
+
+    LevelSetup levelSetup;
+    levelSetup.create(gameData, options.difficulty, options.levelIndex);
+
+    const std::uint32_t* attribPtr =
+        gameData.getLevels().getLevelAttribPtr(options.difficulty, options.levelIndex);
+
+    const std::uint32_t* plotPtr =
+        gameData.getLevels().getLevelPlotDataPtr(options.difficulty, options.levelIndex);
+
+    std::int64_t commandPeriod = options.commandPeriod;
+    if (commandPeriod <= 0)
+        commandPeriod = attribPtr[(int)LevelAttribEnum::SnakePeriod];
+
+    auto challenge = (ChallengeType)plotPtr[(int)LevelPlotDataEnum::Challenge];
+    std::uint32_t challengeCount = plotPtr[(int)LevelPlotDataEnum::ChallengeCount];
+    auto challengeEvent = (GameSubevent)((int)GameSubevent::FruitEaten + (int)challenge);
+
+    Randomizer seedRandomizer;
+    RandomizerSet gameRandomizers;
+    Randomizer inputRandomizer;
+    seedRandomizer.setSeed(options.seed, RandomizerSet::StreamCount + 1);
+    gameRandomizers.setSeed(options.seed);
+    inputRandomizer.setSeed(options.seed, RandomizerSet::StreamCount);
+
+    std::array<Randomizer*, RandomTypeCount> allRands = gameRandomizers.getPointers();
+
+    Game game(levelSetup.createGameImpl(allRands.data()));
+
+    bool recording = !options.recordPath.empty();
+    bool collectingChecksums = recording || !options.replayPath.empty() || !options.checksumPath.empty();
+
+    std::uintmax_t stepCount = 0;
+    std::uintmax_t eventCount = 0;
+    std::uint32_t eatenCount = 0;         // of the challenge items, the current game
+    std::uintmax_t completedCount = 0;
+    std::vector<std::uint64_t> checksums; // of the current game
+
+    std::array<Game::Event, 64> gameEvents;
+
+    auto pollAll = [&]() {
+        std::size_t count;
+        do {
+            count = game.pollEvents(gameEvents.data(), gameEvents.size());
+            eventCount += count;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (gameEvents[i].isMain && gameEvents[i].mainGameEvent == MainGameEvent::Moved) {
+                    ++stepCount;
+                    if (collectingChecksums)
+                        checksums.push_back(gameEvents[i].checksum);
+                } else if (!gameEvents[i].isMain && gameEvents[i].subevent == challengeEvent) {
+                    ++eatenCount;
+                }
+            }
+        } while (count == gameEvents.size());
+    };
+
+    Replay record;
+
+    auto pushCommand = [&](std::int64_t now, Direction direction) {
+        game.pushCommand(now, direction);
+        if (recording)
+            record.addCommand(now, direction);
+    };
+
+    Autopilot autopilot;
+    Autopilot::Statistics autopilotStatistics;
+
+    auto started = std::chrono::steady_clock::now();
+    auto soakEnd = started + std::chrono::seconds(options.soakSeconds);
+    bool soaking = options.autopilot && options.soakSeconds;
+    unsigned int gameIndex = 0;
+
+    for (; soaking ? std::chrono::steady_clock::now() < soakEnd : gameIndex < options.gameCount; ++gameIndex) {
+        checksums.clear();
+        eatenCount = 0;
+
+        if (!options.replayPath.empty()) {
+            gameRandomizers.setSeed(replay.getSeed());
+        } else if (recording) {
+            // its own seed to be replayable alone
+            std::uint64_t runSeed = seedRandomizer.get(0, UINT64_MAX);
+            gameRandomizers.setSeed(runSeed);
+            record.start(options.difficulty, options.levelIndex, runSeed);
+        }
+
+        game.restart(levelSetup.getInitialObjectMemory());
+
+        std::int64_t now = 0;
+
+        if (!options.replayPath.empty()) {
+            const auto& commands = replay.getCommands();
+
+            for (std::size_t i = 0; i < commands.size() && game.getImpl().isSnakeAlive(); ++i) {
+                now = commands[i].time;
+                game.pushCommand(now, commands[i].direction);
+
+                // the commands of one frame go before its update
+                if (i + 1 == commands.size() || commands[i + 1].time != now) {
+                    game.update(now);
+                    pollAll();
+                }
+            }
+
+            now = replay.getEndTime();
+            game.update(now);
+            pollAll();
+        } else if (!script.empty()) {
+            for (const auto& command : script) {
+                if (!game.getImpl().isSnakeAlive())
+                    break;
+
+                now = command.time;
+                pushCommand(now, command.direction);
+                game.update(now);
+                pollAll();
+            }
+
+            // let the snake go until the end
+            now = attribPtr[(int)LevelAttribEnum::TimeLimit];
+            game.update(now);
+            pollAll();
+        } else if (options.autopilot) {
+            autopilot.reset(game.getImpl(), challenge);
+
+            // a command right after every step
+            while (game.getImpl().isSnakeAlive()) {
+                pushCommand(now, autopilot.getCommand());
+                game.update(now);
+
+                std::int64_t timeToMove = game.getEventProcessor().getTimeToEvent((std::size_t)MainGameEvent::Moved);
+                now += (timeToMove > 0 ? timeToMove : commandPeriod);
+                game.update(now);
+                pollAll();
+            }
+
+            const Autopilot::Statistics& statistics = autopilot.getStatistics();
+            autopilotStatistics.commandCount += statistics.commandCount;
+            autopilotStatistics.planCount += statistics.planCount;
+            autopilotStatistics.expansionCount += statistics.expansionCount;
+            autopilotStatistics.fallbackCount += statistics.fallbackCount;
+        } else {
+            while (game.getImpl().isSnakeAlive()) {
+                now += commandPeriod;
+                pushCommand(now, (Direction)inputRandomizer.get(0, DirectionCount - 1));
+                game.update(now);
+                pollAll();
+            }
+        }
+
+        if (eatenCount >= challengeCount)
+            ++completedCount;
+
+        if (recording) {
+            record.finish(now);
+            for (std::uint64_t checksum : checksums)
+                record.addStep(checksum);
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    double seconds = elapsed.count();
+
+    std::cout << "difficulty " << options.difficulty << ", level " << options.levelIndex
+        << " (" << levelSetup.getMapSize().x << 'x' << levelSetup.getMapSize().y << "), "
+        << gameIndex << " games\n";
+    std::cout << "steps: " << stepCount << ", events: " << eventCount
+        << ", time: " << seconds << " s\n";
+
+    if (seconds > 0) {
+        std::cout << "steps/sec: " << (double)stepCount / seconds << '\n';
+        std::cout << "events/sec: " << (double)eventCount / seconds << '\n';
+    }
+
+    if (options.autopilot) {
+        std::cout << "autopilot: " << completedCount << " games completed, "
+            << autopilotStatistics.planCount << " plans, "
+            << autopilotStatistics.expansionCount << " states expanded, "
+            << autopilotStatistics.fallbackCount << " of " << autopilotStatistics.commandCount
+            << " commands with no path\n";
+    }
+
+    printBehaviourProfile();
+
+    if (!options.checksumPath.empty() && !saveChecksums(options.checksumPath, checksums)) {
+        std::cerr << "Failed to save " << options.checksumPath << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (recording) {
+        auto recordLog{ record.saveToFile(options.recordPath) };
+        if (recordLog) {
+            std::cerr << *recordLog << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!options.replayPath.empty()) {
+        std::size_t divergedStep = findDivergence(replay, checksums);
+
+        if (divergedStep != checksums.size() || checksums.size() != replay.getChecksums().size()) {
+            std::cout << "replay diverges at step " << divergedStep << " (of " << checksums.size()
+                << " played, " << replay.getChecksums().size() << " recorded)\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << "replay matches, " << checksums.size() << " steps\n";
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -29,77 +29,9 @@
 #include "ObjParamEnumUtility.hpp"
 #include "EventEnums.hpp"
 #include "Constants.hpp"
+#include <algorithm>
 #include <cassert>
 
-namespace {
-
-template<class Vec>
-sf::Vector2i getRandomPosition(const Vec& probMap,
-                               const sf::Vector2u& mapSize,
-                               CrazySnakes::Randomizer& randomizer) {
-    using fwt = CrazySnakes::FenwickTree<typename Vec::iterator,
-        typename Vec::const_iterator, std::ptrdiff_t, std::uintmax_t>;
-
-    std::uintmax_t modulo = fwt::getSum(probMap.begin(), probMap.size() - 1);
-    if (!modulo) return sf::Vector2i(mapSize);
-
-    std::uintmax_t random = randomizer.get(0, modulo - 1);
-    std::size_t target = fwt::rankQuery(probMap.begin(), probMap.end(), random);
-
-    sf::Vector2i result;
-    result.x = int(target % (std::size_t)mapSize.x);
-    result.y = int(target / (std::size_t)mapSize.x);
-    return result;
-}
-
-void fwkCreate(std::vector<std::uintmax_t>& vec, const std::uint32_t* values,
-            std::size_t sz) {
-    using fwt = CrazySnakes::FenwickTree<std::vector<std::uintmax_t>::iterator,
-        std::vector<std::uintmax_t>::const_iterator, std::ptrdiff_t, std::uintmax_t>;
-
-    constexpr auto realsize = [](std::size_t val) {
-        unsigned int bitlog = 0;
-        std::size_t tval = val ? val - 1 : 0;
-        while (tval) {
-            tval >>= 1;
-            ++bitlog;
-        }
-        return (std::size_t)1 + (val ? ((std::size_t)1u << bitlog) : 0);
-    };
-
-    vec.resize(realsize(sz));
-
-    std::copy(values, values + sz, vec.data() + 1);
-    std::fill(vec.data() + sz + 1, vec.data() + vec.size(), 0);
-    vec[0] = 0;
-    fwt::init(vec.begin(), vec.end());
-}
-
-void fwkReset(std::vector<std::uintmax_t>& vec, const std::uint32_t* values,
-              std::size_t sz) noexcept {
-    using fwt = CrazySnakes::FenwickTree<std::vector<std::uintmax_t>::iterator,
-        std::vector<std::uintmax_t>::const_iterator, std::ptrdiff_t, std::uintmax_t>;
-
-    constexpr auto realsize = [](std::size_t val) {
-        unsigned int bitlog = 0;
-        std::size_t tval = val ? val - 1 : 0;
-        while (tval) {
-            tval >>= 1;
-            ++bitlog;
-        }
-        return (std::size_t)1 + (val ? ((std::size_t)1u << bitlog) : 0);
-    };
-
-    assert(vec.size() == realsize(sz));
-
-    std::copy(values, values + sz, vec.data() + 1);
-    std::fill(vec.data() + sz + 1, vec.data() + vec.size(), 0);
-    vec[0] = 0;
-    fwt::init(vec.begin(), vec.end());
-}
-
-}
-
 namespace CrazySnakes {
 
 SnakeWorld::SnakeWorld(const Map<std::uint32_t>* const* initItemProbArr,
@@ -110,6 +42,13 @@ SnakeWorld::SnakeWorld(const Map<std::uint32_t>* const* initItemProbArr,
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void SnakeWorld::restart(const Map<std::uint32_t>* const* initItemProbArr,
                          const sf::Vector2i& snakePosition) {
+    reset(initItemProbArr);
+    restart(snakePosition);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::reset(const Map<std::uint32_t>* const* initItemProbArr) {
     // assert
     {
         const sf::Vector2u& anchSize = initItemProbArr[0]->getSize();
@@ -125,12 +64,16 @@ void SnakeWorld::restart(const Map<std::uint32_t>* const* initItemProbArr,
               m_initItemProbabilities.begin());
 
     createItemProbs();
-    postInit(snakePosition);
-    m_tailIDs.reset(getMapSize(), (std::size_t)getMapSize().x * getMapSize().y >= TriggerMapSize);
+    m_fruitPositions.clear();
+    m_bonusPositions.clear();
+    m_powerupPositions.clear();
+    m_itemGrid.reset(getMapSize(), nullptr, (std::uint8_t)EatableItem::Count);
+    m_tailIDs.reset(getMapSize());
+    clearUndo();
 }
 
 
-void SnakeWorld::postInit(const sf::Vector2i& snakePosition) noexcept {
+void SnakeWorld::postInit(const sf::Vector2i& snakePosition) {
     
 
     m_backPosition = m_snakePosition = snakePosition;
@@ -141,52 +84,119 @@ void SnakeWorld::postInit(const sf::Vector2i& snakePosition) noexcept {
     // clear other states
     m_previousSnakeDirection = Direction::Count;
 
-    m_bonusPositions.clear();
-    m_fruitPositions.clear();
-    m_powerupPositions.clear();
+    clearItems();
 
     m_stepCount = 0;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void SnakeWorld::restart(const sf::Vector2i& snakePosition) noexcept {
+void SnakeWorld::restart(const sf::Vector2i& snakePosition) {
     resetItemProbs();
     postInit(snakePosition);
-    m_tailIDs.reset((std::size_t)getMapSize().x * getMapSize().y >= TriggerMapSize);
+    m_tailIDs.clear();
+    clearUndo();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::takeSnapshot(Snapshot& snapshot) {
+    if (!m_undoLogged) {
+        m_undoLogged = true;
+        m_tailIDs.setUndoLogged(true);
+        m_itemProbabilities.setUndoLogged(true);
+    }
+
+    snapshot.m_tailMark = m_tailIDs.getUndoMark();
+    snapshot.m_accessMark = m_itemProbabilities.getUndoMark();
+    snapshot.m_itemMark = m_itemUndoLog.size();
+    snapshot.m_stepCount = m_stepCount;
+    snapshot.m_snakePosition = m_snakePosition;
+    snapshot.m_backPosition = m_backPosition;
+    snapshot.m_previousSnakeDirection = m_previousSnakeDirection;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::restoreSnapshot(const Snapshot& snapshot) {
+    assert(m_undoLogged);
+    assert(snapshot.m_itemMark <= m_itemUndoLog.size());
+
+    m_tailIDs.undo(snapshot.m_tailMark);
+    m_itemProbabilities.undo(snapshot.m_accessMark);
+
+    // the items back in reverse, the access is already restored
+    while (m_itemUndoLog.size() > snapshot.m_itemMark) {
+        const ItemUndoEntry& entry = m_itemUndoLog.back();
+        const sf::Vector2i& position = entry.position;
+
+        if (entry.placed) {
+            m_fruitPositions.erase(position);
+            m_bonusPositions.erase(position);
+            m_powerupPositions.erase(position);
+            m_itemGrid.set(position.x, position.y, (std::uint8_t)EatableItem::Count);
+        } else {
+            switch (entry.item) {
+            case EatableItem::Fruit:
+                m_fruitPositions.insert(position);
+                break;
+            case EatableItem::Bonus:
+                m_bonusPositions.insert(position);
+                break;
+            default:
+                m_powerupPositions.insert(std::pair(position, entry.powerup));
+                break;
+            }
+            m_itemGrid.set(position.x, position.y, (std::uint8_t)entry.item);
+        }
+
+        m_itemUndoLog.pop_back();
+    }
+
+    m_stepCount = snapshot.m_stepCount;
+    m_snakePosition = snapshot.m_snakePosition;
+    m_backPosition = snapshot.m_backPosition;
+    m_previousSnakeDirection = snapshot.m_previousSnakeDirection;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::dropSnapshots() {
+    m_undoLogged = false;
+    m_tailIDs.setUndoLogged(false);
+    m_itemProbabilities.setUndoLogged(false);
+    std::vector<ItemUndoEntry>().swap(m_itemUndoLog);
 }
 
 
-const SnakeWorld::TailIdSubList&
+void SnakeWorld::clearUndo() noexcept {
+    m_tailIDs.clearUndo();
+    m_itemProbabilities.clearUndo();
+    m_itemUndoLog.clear();
+}
+
+
+void SnakeWorld::logItem(const sf::Vector2i& position, EatableItem item, bool placed,
+                         PowerupType powerup) {
+    if (m_undoLogged)
+        m_itemUndoLog.push_back(ItemUndoEntry{ position, powerup, item, placed });
+}
+
+
+SnakeWorld::TailIdList
 SnakeWorld::getTailIDs(const sf::Vector2i& position) const noexcept {
     return m_tailIDs.getList(position);
 }
 
 void SnakeWorld::createItemProbs() {
     // item accesses
-    sf::Vector2i mapSize{ getMapSize() };
-    std::size_t area = (std::size_t)mapSize.x * mapSize.y;
-
-    for (int i = 0; i < ItemCount; ++i) {
-        assert(getMapSize() == m_initItemProbabilities[i]->getSize());
-        fwkCreate(m_itemProbabilities[i],
-                  m_initItemProbabilities[i]->data(),
-                  area);
-    }
+    m_itemProbabilities.reset(m_initItemProbabilities.data());
 }
 
 
-void SnakeWorld::resetItemProbs() noexcept {
+void SnakeWorld::resetItemProbs() {
     // item accesses
-    sf::Vector2i mapSize{ getMapSize() };
-    std::size_t area = (std::size_t)mapSize.x * mapSize.y;
-
-    for (int i = 0; i < ItemCount; ++i) {
-        assert(getMapSize() == m_initItemProbabilities[i]->getSize());
-        fwkReset(m_itemProbabilities[i],
-                  m_initItemProbabilities[i]->data(),
-                  area);
-    }
+    m_itemProbabilities.restore();
 }
 
 
@@ -203,9 +213,6 @@ std::uintmax_t SnakeWorld::moveSnake(Direction direction) {
 
     // Save the previous states
     sf::Vector2i previousPosition = m_snakePosition;
-    sf::Vector2i previousNeckPosition;
-    if (m_previousSnakeDirection != Direction::Count)
-        previousNeckPosition = getNeckPosition();
 
     // Move Snake
     moveOnModulus(m_snakePosition, direction, sf::Vector2i(mapSize));
@@ -213,18 +220,15 @@ std::uintmax_t SnakeWorld::moveSnake(Direction direction) {
     // Set the tail
 
     TailDirection tailDirection{};
-    const auto& prevNeckList = m_tailIDs.getList(previousNeckPosition);
 
-    // add 'entry'
-    if (m_previousSnakeDirection != Direction::Count && !prevNeckList.empty())
-        tailDirection.tdentry = prevNeckList.rbegin()->second.tdexit;
-
-    auto& prevList = m_tailIDs.setList(previousPosition);
+    // add 'entry' (the newest segment is on the previous neck)
+    if (m_previousSnakeDirection != Direction::Count && m_tailIDs.size())
+        tailDirection.tdentry = m_tailIDs.back().id.second.tdexit;
 
     // add 'exit'
     tailDirection.tdexit = direction;
 
-    prevList.push_back(std::pair(m_stepCount, tailDirection));
+    m_tailIDs.push(previousPosition, m_stepCount, tailDirection);
 
     m_previousSnakeDirection = direction;
 
@@ -235,14 +239,12 @@ std::uintmax_t SnakeWorld::moveSnake(Direction direction) {
     std::uintmax_t events = 0;
     constexpr std::uintmax_t MAX_ONE = 1;
 
-    if (m_fruitPositions.find(m_snakePosition) != m_fruitPositions.end())
-        events |= (MAX_ONE << (int)GameSubevent::FruitEaten);
-
-    if (m_bonusPositions.find(m_snakePosition) != m_bonusPositions.end())
-        events |= (MAX_ONE << (int)GameSubevent::BonusEaten);
+    static_assert((int)GameSubevent::BonusEaten - (int)GameSubevent::FruitEaten == (int)EatableItem::Bonus &&
+                  (int)GameSubevent::PowerupEaten - (int)GameSubevent::FruitEaten == (int)EatableItem::Powerup);
 
-    if (m_powerupPositions.find(m_snakePosition) != m_powerupPositions.end())
-        events |= (MAX_ONE << (int)GameSubevent::PowerupEaten);
+    std::uint8_t item = m_itemGrid.get(m_snakePosition.x, m_snakePosition.y);
+    if (item != (std::uint8_t)EatableItem::Count)
+        events |= (MAX_ONE << ((int)GameSubevent::FruitEaten + item));
 
     // Add the step
     ++m_stepCount;
@@ -251,20 +253,20 @@ std::uintmax_t SnakeWorld::moveSnake(Direction direction) {
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void SnakeWorld::trimTail() noexcept {
+void SnakeWorld::trimTail() {
     assert(getTailSize());
 
     const sf::Vector2u& mapSize = getMapSize();
-    auto& backList = m_tailIDs.setList(m_backPosition);
+    const TailSegment& backSegment = m_tailIDs.front();
 
-    // open access
-    if (backList.size() == 1)
+    // open access (the last segment on the cell)
+    if (backSegment.nextInCell == NoStep)
         openAccess(m_backPosition);
 
-    Direction backDir = backList.begin()->second.tdexit;
+    Direction backDir = backSegment.id.second.tdexit;
 
     // from tail ids
-    backList.erase(backList.begin());
+    m_tailIDs.pop();
 
     // back position forward
     moveOnModulus(m_backPosition, backDir, sf::Vector2i(mapSize));
@@ -281,6 +283,45 @@ void SnakeWorld::placeFruit(Randomizer& positionRandomizer) {
 
     closeAccess(randPos);
     m_fruitPositions.insert(randPos);
+    m_itemGrid.set(randPos.x, randPos.y, (std::uint8_t)EatableItem::Fruit);
+    logItem(randPos, EatableItem::Fruit, true);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::placeFruits(std::uint32_t count, Randomizer& positionRandomizer) {
+    constexpr auto itemIndex = (std::size_t)EatableItem::Fruit;
+
+    while (count) {
+        std::uintmax_t modulo = m_itemProbabilities.getSum(itemIndex);
+        if (!modulo)
+            return;
+
+        // one descent for all, sorted
+        m_placeValues.resize(count);
+        for (auto& value : m_placeValues)
+            value = positionRandomizer.get(0, modulo - 1);
+
+        std::sort(m_placeValues.begin(), m_placeValues.end());
+
+        m_placeCells.resize(count);
+        m_itemProbabilities.findSorted(itemIndex, m_placeValues.data(), count, m_placeCells.data());
+
+        // a cell drawn more than once is placed once, the rest is drawn again
+        std::size_t placed = std::size_t(std::unique(m_placeCells.begin(), m_placeCells.end()) -
+                                         m_placeCells.begin());
+
+        m_itemProbabilities.close(m_placeCells.data(), placed);
+
+        for (std::size_t i = 0; i < placed; ++i) {
+            const sf::Vector2i& position = m_placeCells[i];
+            m_fruitPositions.insert(position);
+            m_itemGrid.set(position.x, position.y, (std::uint8_t)EatableItem::Fruit);
+            logItem(position, EatableItem::Fruit, true);
+        }
+
+        count -= (std::uint32_t)placed;
+    }
 }
 
 
@@ -294,6 +335,8 @@ void SnakeWorld::placeBonus(Randomizer& positionRandomizer) {
 
     closeAccess(randPos);
     m_bonusPositions.insert(randPos);
+    m_itemGrid.set(randPos.x, randPos.y, (std::uint8_t)EatableItem::Bonus);
+    logItem(randPos, EatableItem::Bonus, true);
 }
 
 
@@ -308,54 +351,78 @@ void SnakeWorld::placePowerup(Randomizer& positionRandomizer, PowerupType certai
     closeAccess(randPos);
     auto pair{ std::pair(randPos, certainPowerup) };
     m_powerupPositions.insert(pair);
+    m_itemGrid.set(randPos.x, randPos.y, (std::uint8_t)EatableItem::Powerup);
+    logItem(randPos, EatableItem::Powerup, true, certainPowerup);
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void SnakeWorld::removeItem(const sf::Vector2i& position) {
-    const auto& mapSize = getMapSize();
-
-    auto fruitFound = m_fruitPositions.find(position);
-    auto bonusFound = m_bonusPositions.find(position);
-    auto powerupFound = m_powerupPositions.find(position);
-
-    if (fruitFound != m_fruitPositions.end())
-        m_fruitPositions.erase(fruitFound);
-    else if (bonusFound != m_bonusPositions.end())
-        m_bonusPositions.erase(bonusFound);
-    else if (powerupFound != m_powerupPositions.end())
-        m_powerupPositions.erase(powerupFound);
-    else
+    EatableItem item = (EatableItem)m_itemGrid.get(position.x, position.y);
+
+    switch (item) {
+    case EatableItem::Fruit:
+        logItem(position, item, false);
+        m_fruitPositions.erase(position);
+        break;
+    case EatableItem::Bonus:
+        logItem(position, item, false);
+        m_bonusPositions.erase(position);
+        break;
+    case EatableItem::Powerup: {
+        auto iter = m_powerupPositions.find(position);
+        logItem(position, item, false, iter->second);
+        m_powerupPositions.erase(iter);
+        break;
+    }
+    default:
         return;
+    }
+
+    m_itemGrid.set(position.x, position.y, (std::uint8_t)EatableItem::Count);
 
-    if (position != m_snakePosition &&
-        m_tailIDs.getList(position).empty())
+    if (position != m_snakePosition && m_tailIDs.getLastStep(position) == NoStep)
         openAccess(position);
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void SnakeWorld::clearBonuses() noexcept {
-    const auto& mapSize = getMapSize();
-
-    for (const auto& now : m_bonusPositions)
-        if (now != m_snakePosition &&
-            m_tailIDs.getList(now).empty())
+void SnakeWorld::clearBonuses() {
+    for (const auto& now : m_bonusPositions) {
+        logItem(now, EatableItem::Bonus, false);
+        m_itemGrid.set(now.x, now.y, (std::uint8_t)EatableItem::Count);
+        if (now != m_snakePosition && m_tailIDs.getLastStep(now) == NoStep)
             openAccess(now);
+    }
 
     m_bonusPositions.clear();
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void SnakeWorld::clearPowerups() noexcept {
-    const auto& mapSize = getMapSize();
+void SnakeWorld::clearPowerups() {
+    for (const auto& now : m_powerupPositions) {
+        logItem(now.first, EatableItem::Powerup, false, now.second);
+        m_itemGrid.set(now.first.x, now.first.y, (std::uint8_t)EatableItem::Count);
+        if (now.first != m_snakePosition && m_tailIDs.getLastStep(now.first) == NoStep)
+            openAccess(now.first);
+    }
+
+    m_powerupPositions.clear();
+}
 
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::clearItems() noexcept {
+    for (const auto& now : m_fruitPositions)
+        m_itemGrid.set(now.x, now.y, (std::uint8_t)EatableItem::Count);
+    for (const auto& now : m_bonusPositions)
+        m_itemGrid.set(now.x, now.y, (std::uint8_t)EatableItem::Count);
     for (const auto& now : m_powerupPositions)
-        if (now.first != m_snakePosition &&
-            m_tailIDs.getList(now.first).empty())
-            openAccess(now.first);
+        m_itemGrid.set(now.first.x, now.first.y, (std::uint8_t)EatableItem::Count);
 
+    m_fruitPositions.clear();
+    m_bonusPositions.clear();
     m_powerupPositions.clear();
 }
 
@@ -365,24 +432,19 @@ std::uintmax_t SnakeWorld::getTailSize() const noexcept {
     if (m_previousSnakeDirection == Direction::Count)
         return 0;
 
-    const sf::Vector2u& mapSize = getMapSize();
-    sf::Vector2i neckPos = getNeckPosition();
-    const auto& neck = m_tailIDs.getList(neckPos);
-
-    if (neck.empty())
-        return 0;
-
-    std::uint64_t thenewest = neck.rbegin()->first;
-    std::uint64_t theoldest = m_tailIDs.getList(m_backPosition).begin()->first;
-    return thenewest + 1 - theoldest;
+    return m_tailIDs.size();
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 sf::Vector2i SnakeWorld::getAvailablePosition(EatableItem item, Randomizer& randomizer) const {
     auto itemIndex = (std::size_t)item;
-    const auto& itemProb = m_itemProbabilities[itemIndex];
-    return getRandomPosition(itemProb, getMapSize(), randomizer);
+
+    std::uintmax_t modulo = m_itemProbabilities.getSum(itemIndex);
+    if (!modulo) return sf::Vector2i(getMapSize());
+
+    std::uintmax_t random = randomizer.get(0, modulo - 1);
+    return m_itemProbabilities.find(itemIndex, random);
 }
 
 
@@ -399,34 +461,20 @@ sf::Vector2i SnakeWorld::getNeckPosition() const noexcept {
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void SnakeWorld::setAccess(int x, int y, EatableItem item, std::uint32_t access) noexcept {
-    std::size_t itemIndex = (std::size_t)item;
-    const auto& mapSize = getMapSize();
-    std::size_t valueIndex = x + (std::size_t)y * mapSize.x;
-
-    using fwt = CrazySnakes::FenwickTree<std::vector<std::uintmax_t>::iterator,
-        std::vector<std::uintmax_t>::const_iterator, std::ptrdiff_t, std::uintmax_t>;
-
-    fwt::update(m_itemProbabilities[itemIndex].begin(),
-                m_itemProbabilities[itemIndex].end(),
-                valueIndex + 1, (std::uintmax_t)access - fwt::get(m_itemProbabilities[itemIndex].begin(),
-                valueIndex)); // not bug, but feature
+void SnakeWorld::setAccess(int x, int y, EatableItem item, std::uint32_t access) {
+    m_itemProbabilities.set((std::size_t)item, x, y, access);
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void SnakeWorld::closeAccess(int x, int y) noexcept {
-    for (int i = 0; i < ItemCount; ++i)
-        setAccess(x, y, EatableItem(i), 0);
+void SnakeWorld::closeAccess(int x, int y) {
+    m_itemProbabilities.close(x, y);
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void SnakeWorld::openAccess(int x, int y) noexcept {
-    for (int i = 0; i < ItemCount; ++i) {
-        const auto& initItemProb = m_initItemProbabilities[i];
-        setAccess(x, y, EatableItem(i), initItemProb->at(x, y));
-    }
+void SnakeWorld::openAccess(int x, int y) {
+    m_itemProbabilities.open(x, y);
 }
 
 
@@ -435,13 +483,17 @@ SnakeWorld::SnakeWorld(SnakeWorld&& src) noexcept :
     m_bonusPositions(std::move(src.m_bonusPositions)),
     m_fruitPositions(std::move(src.m_fruitPositions)),
     m_initItemProbabilities(std::move(src.m_initItemProbabilities)),
+    m_itemGrid(std::move(src.m_itemGrid)),
     m_itemProbabilities(std::move(src.m_itemProbabilities)),
     m_powerupPositions(std::move(src.m_powerupPositions)),
     m_previousSnakeDirection(src.m_previousSnakeDirection),
     m_snakePosition(src.m_snakePosition),
     m_stepCount(src.m_stepCount),
-    m_tailIDs(std::move(src.m_tailIDs)) {
+    m_tailIDs(std::move(src.m_tailIDs)),
+    m_itemUndoLog(std::move(src.m_itemUndoLog)),
+    m_undoLogged(src.m_undoLogged) {
     src.m_stepCount = 0;
+    src.m_undoLogged = false;
 }
 
 
@@ -453,14 +505,18 @@ SnakeWorld& SnakeWorld::operator=(SnakeWorld&& src) noexcept {
     m_bonusPositions = std::move(src.m_bonusPositions);
     m_fruitPositions = std::move(src.m_fruitPositions);
     m_initItemProbabilities = std::move(src.m_initItemProbabilities);
+    m_itemGrid = std::move(src.m_itemGrid);
     m_itemProbabilities = std::move(src.m_itemProbabilities);
     m_powerupPositions = std::move(src.m_powerupPositions);
     m_previousSnakeDirection = src.m_previousSnakeDirection;
     m_snakePosition = src.m_snakePosition;
     m_stepCount = src.m_stepCount;
     m_tailIDs = std::move(src.m_tailIDs);
+    m_itemUndoLog = std::move(src.m_itemUndoLog);
+    m_undoLogged = src.m_undoLogged;
 
     src.m_stepCount = 0;
+    src.m_undoLogged = false;
 
     return *this;
 }
@@ -478,11 +534,7 @@ Direction SnakeWorld::getPreviousDirection() const noexcept {
 
 std::uint32_t SnakeWorld::getCurrentRelativeItemAcquireProb(EatableItem item, 
                                                             int x, int y) const noexcept {
-    using fwt = CrazySnakes::FenwickTree<std::vector<std::uintmax_t>::iterator,
-        std::vector<std::uintmax_t>::const_iterator, std::ptrdiff_t, std::uintmax_t>;
-
-    return (std::uint32_t)fwt::get(m_itemProbabilities[(std::size_t)item].begin(),
-                    (std::ptrdiff_t)x + (std::ptrdiff_t)y * getMapSize().x);
+    return m_itemProbabilities.get((std::size_t)item, x, y);
 }
 
 
@@ -511,75 +563,195 @@ const sf::Vector2u& SnakeWorld::getMapSize() const noexcept {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void SnakeWorld::setAccess(const sf::Vector2i& position, EatableItem item, 
-                           std::uint32_t access) noexcept {
+                           std::uint32_t access) {
     setAccess(position.x, position.y, item, access);
 }
 
-void SnakeWorld::openAccess(const sf::Vector2i& position) noexcept {
+void SnakeWorld::openAccess(const sf::Vector2i& position) {
     openAccess(position.x, position.y);
 }
 
-void SnakeWorld::closeAccess(const sf::Vector2i& position) noexcept {
+void SnakeWorld::closeAccess(const sf::Vector2i& position) {
     closeAccess(position.x, position.y);
 }
 
-void SnakeWorld::TaidIdContainer::reset(const sf::Vector2u& newsize, bool enable_map) 
-{
-    if (is_map && enable_map) {
-        TailIdMap().swap(map);
-    } else if (!is_map && enable_map) {
-        TailIdVector().swap(vector);
-    } else if (is_map && !enable_map) {
-        TailIdMap().swap(map);
-        TailIdVector((std::size_t)newsize.x * newsize.y).swap(vector);
-    } else {
-        TailIdVector().swap(vector);
-        vector.resize((std::size_t)newsize.x * newsize.y);
-    }
-    size = newsize;
-    is_map = enable_map;
-}
-
-void SnakeWorld::TaidIdContainer::reset(bool enable_map) noexcept {
-    if (is_map && enable_map) {
-        TailIdMap().swap(map);
-    } else if (!is_map && enable_map) {
-        TailIdVector().swap(vector);
-    } else if (is_map && !enable_map) {
-        TailIdMap().swap(map);
-        TailIdVector((std::size_t)size.x * size.y).swap(vector);
-    } else {
-        TailIdVector().swap(vector);
-        std::for_each(vector.begin(), vector.end(),
-                      [](TailIdSubList& item) {
-                          TailIdSubList().swap(item);
-                      });
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::TailRing::reset(const sf::Vector2u& mapSize) {
+    m_cellSlots.reset(mapSize, nullptr, NoSlot);
+    clear();
+}
+
+
+void SnakeWorld::TailRing::clear() noexcept {
+    m_begin = 0;
+    m_end = 0;
+    m_undoLog.clear();
+
+    // the visited cells only
+    m_cellSlots.restore();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::TailRing::push(const sf::Vector2i& position, std::uintmax_t stepId,
+                                const TailDirection& direction) {
+    assert(stepId == m_end);
+
+    if (size() == m_segments.size())
+        grow();
+
+    std::uintmax_t lastInCell = getLastStep(position);
+    if (lastInCell != NoStep)
+        m_segments[lastInCell & m_mask].nextInCell = stepId;
+
+    TailSegment& segment = m_segments[stepId & m_mask];
+    segment.id = TailId(stepId, direction);
+    segment.previousInCell = lastInCell;
+    segment.nextInCell = NoStep;
+    segment.position = position;
+
+    m_cellSlots.set(position.x, position.y, (std::uint32_t)(stepId & m_mask));
+    m_end = stepId + 1;
+
+    if (m_undoLogged)
+        m_undoLog.emplace_back();
+}
+
+
+void SnakeWorld::TailRing::pop() {
+    assert(size());
+
+    const TailSegment& segment = front();
+    if (segment.nextInCell == NoStep)
+        m_cellSlots.set(segment.position.x, segment.position.y, NoSlot);
+
+    // a later push can take the slot
+    if (m_undoLogged)
+        m_undoLog.push_back(segment);
+
+    ++m_begin;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::TailRing::setUndoLogged(bool logged) {
+    m_undoLogged = logged;
+    if (!logged)
+        std::vector<TailSegment>().swap(m_undoLog);
+}
+
+
+// The steps are logged, not the slots, so the ring may grow meanwhile.
+// Going backwards, the ring is as right after the operation undone.
+void SnakeWorld::TailRing::undo(std::size_t mark) {
+    assert(mark <= m_undoLog.size());
+
+    while (m_undoLog.size() > mark) {
+        const TailSegment& entry = m_undoLog.back();
+
+        if (entry.id.first == NoStep) {
+            // the push: the newest one goes, the older one on its cell is the last again
+            const TailSegment& segment = back();
+            std::uint32_t slot = NoSlot;
+
+            if (segment.previousInCell != NoStep) {
+                m_segments[segment.previousInCell & m_mask].nextInCell = NoStep;
+                slot = (std::uint32_t)(segment.previousInCell & m_mask);
+            }
+
+            m_cellSlots.set(segment.position.x, segment.position.y, slot);
+            --m_end;
+        } else {
+            // the pop: the ring held it before, so its slot is free now
+            assert(entry.id.first + 1 == m_begin);
+
+            m_segments[entry.id.first & m_mask] = entry;
+            if (entry.nextInCell == NoStep)
+                m_cellSlots.set(entry.position.x, entry.position.y, (std::uint32_t)(entry.id.first & m_mask));
+
+            --m_begin;
+        }
+
+        m_undoLog.pop_back();
     }
-    is_map = enable_map;
 }
 
-const SnakeWorld::TailIdSubList& SnakeWorld::TaidIdContainer::getList(const sf::Vector2i& position)
-const noexcept {
-    if (is_map) {
-        auto iter = map.find(position);
-        
-        if (iter == map.end())
-            return VirtualSublist;
 
-        return iter->second;
-    } else {
-        return vector[position.x + (std::size_t)position.y * size.x];
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::uintmax_t SnakeWorld::TailRing::getLastStep(const sf::Vector2i& position) const noexcept {
+    std::uint32_t slot = m_cellSlots.get(position.x, position.y);
+    if (slot == NoSlot || slot >= m_segments.size())
+        return NoStep;
+
+    const TailSegment& segment = m_segments[slot];
+
+    if (segment.position != position || !isAlive(segment.id.first))
+        return NoStep;
+
+    return segment.id.first;
+}
+
+
+SnakeWorld::TailIdList SnakeWorld::TailRing::getList(const sf::Vector2i& position) const noexcept {
+    TailIdList list;
+    list.m_segments = m_segments.data();
+    list.m_mask = m_mask;
+
+    std::uintmax_t step = getLastStep(position);
+    if (step != NoStep) {
+        // go to the oldest alive one
+        while (isAlive(m_segments[step & m_mask].previousInCell))
+            step = m_segments[step & m_mask].previousInCell;
     }
+
+    list.m_first = step;
+    return list;
 }
 
-SnakeWorld::TailIdSubList& SnakeWorld::TaidIdContainer::setList(const sf::Vector2i& position) {
-    if (is_map) {
-        return map[position];
-    } else {
-        return vector[position.x + (std::size_t)position.y * size.x];
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SnakeWorld::TailRing::grow() {
+    std::size_t capacity = (m_segments.empty() ? 16 : m_segments.size() * 2);
+    assert(capacity - 1 < NoSlot);
+
+    std::vector<TailSegment> segments(capacity);
+    std::size_t mask = capacity - 1;
+
+    // alive segments only, so the cells get their new slots
+    for (std::uintmax_t step = m_begin; step != m_end; ++step) {
+        const TailSegment& segment = m_segments[step & m_mask];
+        segments[step & mask] = segment;
+        m_cellSlots.set(segment.position.x, segment.position.y, (std::uint32_t)(step & mask));
     }
+
+    m_segments.swap(segments);
+    m_mask = mask;
 }
 
-const SnakeWorld::TailIdSubList SnakeWorld::TaidIdContainer::VirtualSublist;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+SnakeWorld::TailIdList::Iterator SnakeWorld::TailIdList::begin() const noexcept {
+    Iterator iter;
+    iter.m_segments = m_segments;
+    iter.m_mask = m_mask;
+    iter.m_step = m_first;
+    return iter;
+}
+
+
+SnakeWorld::TailIdList::Iterator SnakeWorld::TailIdList::end() const noexcept {
+    Iterator iter;
+    iter.m_segments = m_segments;
+    iter.m_mask = m_mask;
+    return iter;
+}
+
+
+std::size_t SnakeWorld::TailIdList::size() const noexcept {
+    std::size_t count = 0;
+    for (auto iter = begin(); iter != end(); ++iter)
+        ++count;
+    return count;
+}
 
 } // namespace CrazySnakes
\ No newline at end of file
@@ -30,11 +30,13 @@
 #include "EatableItem.hpp"
 #include "ObjectParameterEnums.hpp"
 #include "Map.hpp"
+#include "PagedGrid.hpp"
+#include "AccessTree.hpp"
 #include <array>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
-#include <list>
+#include <cstdint>
 
 namespace CrazySnakes {
 class Randomizer;
@@ -75,9 +77,83 @@ public:
     using ItemSet = std::unordered_set<sf::Vector2i, Vector2iHash>;
     using PowerupMap = std::unordered_map<sf::Vector2i, PowerupType, Vector2iHash>;
     
-    using TailIdSubList = std::list<std::pair<std::uintmax_t, TailDirection>>;
-    using TailIdVector = std::vector<TailIdSubList>;
-    using TailIdMap = std::unordered_map<sf::Vector2i, TailIdSubList, Vector2iHash>;
+    using TailId = std::pair<std::uintmax_t, TailDirection>;
+
+    static constexpr std::uintmax_t NoStep = UINTMAX_MAX;
+
+    // One step of the tail, kept in the ring by its step id
+    struct TailSegment {
+        TailId id{ NoStep, TailDirection{} };
+        std::uintmax_t previousInCell = NoStep; // older segment on the same cell
+        std::uintmax_t nextInCell = NoStep;     // newer segment on the same cell
+        sf::Vector2i position;
+    };
+
+    /// Tail IDs on one cell from the oldest to the newest (a view into the ring).
+    /// Valid until the next move or trim.
+    class TailIdList {
+    public:
+
+        class Iterator {
+        public:
+
+            const TailId& operator*() const noexcept {
+                return m_segments[m_step & m_mask].id;
+            }
+            const TailId* operator->() const noexcept {
+                return &m_segments[m_step & m_mask].id;
+            }
+            Iterator& operator++() noexcept {
+                m_step = m_segments[m_step & m_mask].nextInCell;
+                return *this;
+            }
+            bool operator==(const Iterator& other) const noexcept {
+                return m_step == other.m_step;
+            }
+            bool operator!=(const Iterator& other) const noexcept {
+                return m_step != other.m_step;
+            }
+
+        private:
+
+            friend class TailIdList;
+
+            const TailSegment* m_segments = nullptr;
+            std::size_t m_mask = 0;
+            std::uintmax_t m_step = NoStep;
+        };
+
+        Iterator begin() const noexcept;
+        Iterator end() const noexcept;
+
+        bool empty() const noexcept {
+            return m_first == NoStep;
+        }
+        std::size_t size() const noexcept;
+
+    private:
+
+        friend class SnakeWorld;
+
+        const TailSegment* m_segments = nullptr;
+        std::size_t m_mask = 0;
+        std::uintmax_t m_first = NoStep;
+    };
+
+    // The world to come back to (see takeSnapshot)
+    class Snapshot {
+    private:
+
+        friend class SnakeWorld;
+
+        std::size_t m_tailMark = 0;
+        std::size_t m_accessMark = 0;
+        std::size_t m_itemMark = 0;
+        std::uintmax_t m_stepCount = 0;
+        sf::Vector2i m_snakePosition;
+        sf::Vector2i m_backPosition;
+        Direction m_previousSnakeDirection{};
+    };
 
     SnakeWorld() noexcept;
 
@@ -90,21 +166,36 @@ public:
     // create the world
     SnakeWorld(const Map<std::uint32_t>* const* initItemProbArr, const sf::Vector2i& snakePosition);
     void restart(const Map<std::uint32_t>* const* initItemProbArr, const sf::Vector2i& snakePosition);
-    void restart(const sf::Vector2i& snakePosition) noexcept;
+
+    // create the world without the snake, restart it then
+    void reset(const Map<std::uint32_t>* const* initItemProbArr);
+
+    // on the same maps: only the cells changed since the last restart are restored
+    void restart(const sf::Vector2i& snakePosition);
+
+    // Since the first snapshot the changes are logged, restoring a snapshot undoes them back to it
+    // and costs as much as they are; the snapshots taken after it are invalid then.
+    // Restarting drops all the snapshots, so does dropSnapshots (the logging stops).
+    void takeSnapshot(Snapshot& snapshot);
+    void restoreSnapshot(const Snapshot& snapshot);
+    void dropSnapshots();
 
     // if opposite, it will be just ignored
     // can return some of these subevents: FruitEaten, BonusEaten, PowerupEaten
     // Don't forget to use trimTail
     std::uintmax_t moveSnake(Direction direction);
-    void trimTail() noexcept;
+    void trimTail();
 
     void placeFruit(Randomizer& positionRandomizer);
+
+    // count fruits at once, each cell drawn in proportion among the ones still free
+    void placeFruits(std::uint32_t count, Randomizer& positionRandomizer);
     void placeBonus(Randomizer& positionRandomizer);
     void placePowerup(Randomizer& positionRandomizer, PowerupType certainPowerup);
 
     void removeItem(const sf::Vector2i& position);
-    void clearBonuses() noexcept;
-    void clearPowerups() noexcept;
+    void clearBonuses();
+    void clearPowerups();
 
     const sf::Vector2i& getCurrentSnakePosition() const noexcept {
         return m_snakePosition;
@@ -132,7 +223,23 @@ public:
     const sf::Vector2i& getBackPosition()   const noexcept {
         return m_backPosition;
     }
-    const TailIdSubList& getTailIDs(const sf::Vector2i& position) const noexcept;
+    TailIdList getTailIDs(const sf::Vector2i& position) const noexcept;
+
+    // f(const TailSegment&) from the back to the neck
+    template<class F>
+    void forEachTailSegment(F&& f) const {
+        m_tailIDs.forEach(f);
+    }
+
+    // the item on the position or EatableItem::Count
+    EatableItem getItem(const sf::Vector2i& position) const noexcept {
+        return (EatableItem)m_itemGrid.get(position.x, position.y);
+    }
+
+    // the items of all the cells (EatableItem), to read many at once
+    const PagedGrid<std::uint8_t>& getItemGrid() const noexcept {
+        return m_itemGrid;
+    }
 
     std::uintmax_t       getStepCount()      const noexcept {
         return m_stepCount;
@@ -140,59 +247,128 @@ public:
 
 private:
 
-    // technically two similar functions but one is with noexcept
+    // the tree built from the initial probabilities / the changed cells back to them
     void createItemProbs();
-    void resetItemProbs() noexcept;
-    void postInit(const sf::Vector2i& snakePosition) noexcept;
+    void resetItemProbs();
+    void postInit(const sf::Vector2i& snakePosition);
 
     /// Change the access of the map position.
     /// The access of position means the status whether the item acquire there or not.
-    void setAccess(int x, int y, EatableItem item, std::uint32_t access) noexcept;
+    void setAccess(int x, int y, EatableItem item, std::uint32_t access);
 
-    void openAccess(int x, int y) noexcept;
-    void closeAccess(int x, int y) noexcept;
+    void openAccess(int x, int y);
+    void closeAccess(int x, int y);
 
     /// Get the random free position for acquiring item.
     [[nodiscard]] sf::Vector2i getAvailablePosition(EatableItem item, Randomizer& randomizer) const;
 
     // ALIASES
-    void setAccess(const sf::Vector2i& position, EatableItem item, std::uint32_t access) noexcept;
-    void openAccess(const sf::Vector2i& position) noexcept;
-    void closeAccess(const sf::Vector2i& position) noexcept;
+    void setAccess(const sf::Vector2i& position, EatableItem item, std::uint32_t access);
+    void openAccess(const sf::Vector2i& position);
+    void closeAccess(const sf::Vector2i& position);
 
     sf::Vector2i getNeckPosition() const noexcept;
 
+    void clearItems() noexcept;
+
+    // the item change to undo
+    void logItem(const sf::Vector2i& position, EatableItem item, bool placed,
+                 PowerupType powerup = PowerupType{});
+
+    void clearUndo() noexcept;
+
     ////////////////////////////////////////////////////////////
     /// Member data
     ////////////////////////////////////////////////////////////
 
-    class TaidIdContainer {
+    /// The snake body as one ring of segments indexed by step id.
+    /// Every cell keeps the ring slot of its newest segment, the older ones are chained.
+    /// Trimming the last segment of a cell frees its slot (so the pages can be released),
+    /// otherwise the slot is stale when its segment belongs to another cell or has gone.
+    /// Restarting touches only the cells the snake has been on.
+    class TailRing {
     public:
 
-        void reset(const sf::Vector2u& newsize, bool enable_map);
-        void reset(bool enable_map) noexcept;
+        void reset(const sf::Vector2u& mapSize);
+        void clear() noexcept;
+
+        void push(const sf::Vector2i& position, std::uintmax_t stepId, const TailDirection& direction);
+        void pop();
+
+        std::uintmax_t size() const noexcept {
+            return m_end - m_begin;
+        }
+
+        const TailSegment& front() const noexcept {
+            return m_segments[m_begin & m_mask];
+        }
 
-        const TailIdSubList& getList(const sf::Vector2i& position) const noexcept;
+        const TailSegment& back() const noexcept {
+            return m_segments[(m_end - 1) & m_mask];
+        }
 
-        TailIdSubList& setList(const sf::Vector2i& position) ;
+        // the newest segment on the cell or NoStep
+        std::uintmax_t getLastStep(const sf::Vector2i& position) const noexcept;
+
+        TailIdList getList(const sf::Vector2i& position) const noexcept;
+
+        template<class F>
+        void forEach(F&& f) const {
+            for (std::uintmax_t step = m_begin; step != m_end; ++step)
+                f(m_segments[step & m_mask]);
+        }
+
+        // the pushes and pops are logged the same as for the AccessTree
+        void setUndoLogged(bool logged);
+
+        std::size_t getUndoMark() const noexcept {
+            return m_undoLog.size();
+        }
+
+        void undo(std::size_t mark);
+
+        void clearUndo() noexcept {
+            m_undoLog.clear();
+        }
 
     private:
 
-        
-        TailIdMap map;
-        TailIdVector vector;
-        sf::Vector2u size;
-        bool is_map = true;
-        static const TailIdSubList VirtualSublist;
+        bool isAlive(std::uintmax_t stepId) const noexcept {
+            return stepId >= m_begin && stepId < m_end;
+        }
+
+        void grow();
+
+        static constexpr std::uint32_t NoSlot = UINT32_MAX;
+
+        std::vector<TailSegment> m_segments; // the capacity is a power of 2
+        PagedGrid<std::uint32_t> m_cellSlots; // NoSlot if the cell is free
+        std::size_t m_mask = 0;
+        std::uintmax_t m_begin = 0; // the oldest step id
+        std::uintmax_t m_end = 0;   // the newest step id + 1
+        std::vector<TailSegment> m_undoLog; // the popped segments, NoStep ids for the pushes
+        bool m_undoLogged = false;
+    };
+
+    struct ItemUndoEntry {
+        sf::Vector2i position;
+        PowerupType powerup;
+        EatableItem item;
+        bool placed; // or removed
     };
 
-    TaidIdContainer m_tailIDs; // Tail IDs
-    std::array<std::vector<std::uintmax_t>, ItemCount> m_itemProbabilities; 
+    TailRing m_tailIDs; // Tail IDs
+    AccessTree m_itemProbabilities; 
     // For placing fruits, bonuses, powerups
     
     ItemSet m_fruitPositions; // Fruit position on the map
     ItemSet m_bonusPositions; // Bonus position on the map
     PowerupMap m_powerupPositions; // Powerup position on the map
+    PagedGrid<std::uint8_t> m_itemGrid; // EatableItem on every cell, Count if none (mirrors the sets above)
+    std::vector<ItemUndoEntry> m_itemUndoLog; // item changes since the first snapshot
+    std::vector<std::uintmax_t> m_placeValues; // placeFruits() only
+    std::vector<sf::Vector2i> m_placeCells;     // placeFruits() only
+    bool m_undoLogged = false;
     std::array<const Map<std::uint32_t>*, ItemCount> m_initItemProbabilities; // Dependencies
     std::uintmax_t m_stepCount = 0; // Total step count
     sf::Vector2i m_snakePosition; // Snake's head position on the map       
@@ -203,4 +379,4 @@ private:
 
 } // namespace CrazySnakes
 
-#endif // !SNAKE_WORLD_HPP
\ No newline at end of file
+#endif // !SNAKE_WORLD_HPP
\ No newline at end of file
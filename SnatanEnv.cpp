@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#include "SnatanEnv.h"
+#include "VectorEnvironment.hpp"
+#include "GameData.hpp"
+#include "LevelElements.hpp"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+
+using namespace CrazySnakes;
+
+static_assert(SNATAN_PLANE_OBJECT == (int)VectorEnvironment::Plane::Object &&
+              SNATAN_PLANE_OBJECT_MEMORY == (int)VectorEnvironment::Plane::ObjectMemory &&
+              SNATAN_PLANE_ITEM == (int)VectorEnvironment::Plane::Item &&
+              SNATAN_PLANE_SNAKE == (int)VectorEnvironment::Plane::Snake &&
+              SNATAN_PLANE_COUNT == VectorEnvironment::PlaneCount);
+
+static_assert(SNATAN_ACTION_UP == (int)Direction::Up && SNATAN_ACTION_RIGHT == (int)Direction::Right &&
+              SNATAN_ACTION_DOWN == (int)Direction::Down && SNATAN_ACTION_LEFT == (int)Direction::Left &&
+              SNATAN_ACTION_NONE == VectorEnvironment::NoAction);
+
+struct SnatanEnv {
+    GameData data;
+    LevelSetup setup;
+    VectorEnvironment environment;
+};
+
+namespace {
+
+void writeError(const std::string& message, char* error, std::size_t errorSize) noexcept {
+    if (!error || !errorSize)
+        return;
+
+    std::size_t length = std::min(message.size(), errorSize - 1);
+    std::memcpy(error, message.data(), length);
+    error[length] = '\0';
+}
+
+}
+
+
+SnatanEnv* snatan_env_create(const SnatanEnvConfig* config, char* error, size_t errorSize) {
+    try {
+        if (!config || !config->dataPath || !config->gameCount) {
+            writeError("no data path or no games", error, errorSize);
+            return nullptr;
+        }
+
+        if (config->difficulty >= config->difficultyCount || config->level >= config->levelCount) {
+            writeError("no such level", error, errorSize);
+            return nullptr;
+        }
+
+        auto env = std::make_unique<SnatanEnv>();
+
+        std::optional<std::string> loadError = env->data.loadFromFile(config->dataPath, config->difficultyCount,
+                                                                      config->levelCount);
+        if (loadError) {
+            writeError(*loadError, error, errorSize);
+            return nullptr;
+        }
+
+        env->setup.create(env->data, config->difficulty, config->level);
+
+        VectorEnvironment::Options options;
+        options.gameCount = config->gameCount;
+        options.seed = config->seed;
+        options.stepLimit = (std::uintmax_t)config->stepLimit;
+        env->environment.reset(env->setup, options);
+
+        return env.release();
+    } catch (const std::exception& exception) {
+        writeError(exception.what(), error, errorSize);
+    } catch (...) {
+        writeError("unknown error", error, errorSize);
+    }
+
+    return nullptr;
+}
+
+
+void snatan_env_destroy(SnatanEnv* env) {
+    delete env;
+}
+
+
+size_t snatan_env_game_count(const SnatanEnv* env) {
+    return env->environment.getGameCount();
+}
+
+
+void snatan_env_window_size(const SnatanEnv* env, size_t* width, size_t* height) {
+    const sf::Vector2u& size = env->environment.getWindowSize();
+    *width = size.x;
+    *height = size.y;
+}
+
+
+size_t snatan_env_observation_size(const SnatanEnv* env) {
+    return env->environment.getObservationSize();
+}
+
+
+int snatan_env_reset(SnatanEnv* env, uint8_t* observations) {
+    try {
+        env->environment.restart(observations);
+        return 0;
+    } catch (...) {
+        return -1;
+    }
+}
+
+
+int snatan_env_step(SnatanEnv* env, const uint32_t* actions, uint8_t* observations,
+                    float* rewards, uint8_t* dones) {
+    try {
+        env->environment.step(actions, observations, rewards, dones);
+        return 0;
+    } catch (...) {
+        return -1;
+    }
+}
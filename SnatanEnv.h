@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+/* The C interface of VectorEnvironment (libsnatan_env.so): many games of one level
+   stepped together, for reinforcement learning. No function throws, the buffers are the caller's. */
+
+#ifndef SNATAN_ENV_H
+#define SNATAN_ENV_H
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the observation planes, a byte per cell each */
+enum {
+    SNATAN_PLANE_OBJECT = 0,        /* ObjectPair + 1 (255 for 254 and more), 0 beyond the visible zone */
+    SNATAN_PLANE_OBJECT_MEMORY = 1, /* the object memory, 255 at most */
+    SNATAN_PLANE_ITEM = 2,          /* EatableItem + 1, 0 if none */
+    SNATAN_PLANE_SNAKE = 3,         /* 1 on the tail, 2 on the head */
+    SNATAN_PLANE_COUNT = 4
+};
+
+/* the actions: Direction, or none to let the snake go on */
+enum {
+    SNATAN_ACTION_UP = 0,
+    SNATAN_ACTION_RIGHT = 1,
+    SNATAN_ACTION_DOWN = 2,
+    SNATAN_ACTION_LEFT = 3,
+    SNATAN_ACTION_NONE = 4
+};
+
+typedef struct SnatanEnvConfig {
+    const char* dataPath;          /* Resources/data.bin */
+    unsigned int difficultyCount;  /* in the data file: 3 */
+    unsigned int levelCount;       /* in the data file: 12 */
+    unsigned int difficulty;
+    unsigned int level;
+    size_t gameCount;
+    uint64_t seed;
+    uint64_t stepLimit;            /* the game restarts after so many steps, 0 means never */
+} SnatanEnvConfig;
+
+typedef struct SnatanEnv SnatanEnv;
+
+/* NULL on failure, the message is then written to error (if errorSize != 0) */
+SnatanEnv* snatan_env_create(const SnatanEnvConfig* config, char* error, size_t errorSize);
+void snatan_env_destroy(SnatanEnv* env);
+
+size_t snatan_env_game_count(const SnatanEnv* env);
+
+/* the observation window of a game: SNATAN_PLANE_COUNT planes of height rows of width bytes */
+void snatan_env_window_size(const SnatanEnv* env, size_t* width, size_t* height);
+size_t snatan_env_observation_size(const SnatanEnv* env);
+
+/* All the games from the start. observations: snatan_env_observation_size() bytes per game.
+   0 on success, -1 if out of memory (the games are to be reset then) */
+int snatan_env_reset(SnatanEnv* env, uint8_t* observations);
+
+/* A snake move in every game. actions, rewards (the score got) and dones: one per game.
+   A finished game restarts at once and observes the new start. 0 or -1 as snatan_env_reset */
+int snatan_env_step(SnatanEnv* env, const uint32_t* actions, uint8_t* observations,
+                     float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SNATAN_ENV_H */
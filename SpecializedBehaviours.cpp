@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#include "SpecializedBehaviours.hpp"
+#include "LevelElements.hpp"
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SpecializedBehaviours::build(const std::vector<ObjectBehaviour>& behaviours,
+                                  const std::uint32_t* preEffectBehIndices,
+                                  const std::uint32_t* postEffectBehIndices,
+                                  const std::uint32_t* objectPairIndices,
+                                  const std::uint32_t* objectParams, std::size_t area) {
+    m_behaviours = behaviours.data();
+    m_specialized.clear();
+    m_indices.assign(behaviours.size() * ParamLimit, NoIndex);
+
+    // the parameters of the pairs used on the map
+    std::vector<bool> used((std::size_t)ObjectPairCount * ParamLimit, false);
+    for (std::size_t i = 0; i < area; ++i) {
+        if (objectParams[i] < ParamLimit)
+            used[(std::size_t)objectPairIndices[i] * ParamLimit + objectParams[i]] = true;
+    }
+
+    for (std::size_t pair = 0; pair < (std::size_t)ObjectPairCount; ++pair) {
+        for (std::uint32_t param = 0; param < ParamLimit; ++param) {
+            if (!used[pair * ParamLimit + param])
+                continue;
+
+            for (std::uint32_t behaviourIndex : { preEffectBehIndices[pair], postEffectBehIndices[pair] }) {
+                const ObjectBehaviour& behaviour = behaviours[behaviourIndex];
+                std::uint32_t& index = m_indices[(std::size_t)behaviourIndex * ParamLimit + param];
+
+                if (index != NoIndex || behaviour.getParameterType() == ObjectParameterType::NoParameter)
+                    continue;
+
+                index = (std::uint32_t)m_specialized.size();
+                m_specialized.push_back(behaviour.specialize(param));
+            }
+        }
+    }
+}
+
+} // namespace CrazySnakes
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef SPECIALIZED_BEHAVIOURS_HPP
+#define SPECIALIZED_BEHAVIOURS_HPP
+#include "ObjectBehaviour.hpp"
+#include "ObjectTransitions.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+/// The behaviours of one level specialized (see ObjectBehaviour::specialize) for every
+/// parameter they get on the map, so the object effects run the shortest programs.
+/// The behaviours without any parameter and the parameters from ParamLimit on
+/// are run as they are.
+class SpecializedBehaviours {
+public:
+
+    static constexpr std::uint32_t ParamLimit = ObjectTransitions::ParamLimit;
+
+    // behaviours: all the behaviours of the game data (the indices of the pairs refer to them), a dependency;
+    // the maps are of area cells
+    void build(const std::vector<ObjectBehaviour>& behaviours,
+               const std::uint32_t* preEffectBehIndices, const std::uint32_t* postEffectBehIndices,
+               const std::uint32_t* objectPairIndices, const std::uint32_t* objectParams, std::size_t area);
+
+    // inline, it's on the path of every object effect (see GameImpl::objectEffect)
+    const ObjectBehaviour& get(std::uint32_t behaviourIndex, std::uint32_t param) const noexcept {
+        if (param < ParamLimit) {
+            std::uint32_t index = m_indices[(std::size_t)behaviourIndex * ParamLimit + param];
+            if (index != NoIndex)
+                return m_specialized[index];
+        }
+        return m_behaviours[behaviourIndex];
+    }
+
+    std::size_t getSpecializedCount() const noexcept {
+        return m_specialized.size();
+    }
+
+private:
+
+    static constexpr std::uint32_t NoIndex = UINT32_MAX;
+
+    const ObjectBehaviour* m_behaviours = nullptr;
+    std::vector<ObjectBehaviour> m_specialized;
+    std::vector<std::uint32_t> m_indices; // by the behaviour and the parameter, NoIndex if not specialized
+};
+
+} // namespace CrazySnakes
+
+#endif // !SPECIALIZED_BEHAVIOURS_HPP
@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#ifndef TIMER_HEAP_HPP
+#define TIMER_HEAP_HPP
+#include <cstddef>
+#include <array>
+
+namespace CrazySnakes {
+
+// Timers by absolute deadlines in a binary min-heap indexed by the timer,
+// for up to N concurrent timers: O(1) to peek the soonest one,
+// O(log N) to schedule, reschedule or cancel one.
+template<class time_t, std::size_t N>
+class TimerHeap {
+public:
+
+    TimerHeap() noexcept;
+
+    bool empty() const noexcept {
+        return !m_size;
+    }
+
+    std::size_t size() const noexcept {
+        return m_size;
+    }
+
+    bool isActive(std::size_t timer) const noexcept {
+        return m_positions[timer] != NoPosition;
+    }
+
+    // active only
+    time_t getDeadline(std::size_t timer) const noexcept {
+        return m_deadlines[timer];
+    }
+
+    // the soonest timer (not empty)
+    std::size_t getTop() const noexcept {
+        return m_heap[0];
+    }
+
+    time_t getTopDeadline() const noexcept {
+        return m_deadlines[m_heap[0]];
+    }
+
+    // new or rescheduled
+    void schedule(std::size_t timer, time_t deadline) noexcept;
+
+    void cancel(std::size_t timer) noexcept;
+
+    // the soonest timer gone
+    void pop() noexcept {
+        cancel(m_heap[0]);
+    }
+
+    // Calls f(timer) for the active timers with the deadline not later than the given one,
+    // in no particular order. Costs as much as the timers found.
+    template<class F>
+    void forEachDue(time_t deadline, F&& f) const;
+
+    // no timers
+    void clear() noexcept;
+
+private:
+
+    static constexpr std::size_t NoPosition = N;
+
+    bool isEarlier(std::size_t left, std::size_t right) const noexcept {
+        return m_deadlines[m_heap[left]] < m_deadlines[m_heap[right]];
+    }
+
+    void place(std::size_t position, std::size_t timer) noexcept {
+        m_heap[position] = timer;
+        m_positions[timer] = position;
+    }
+
+    void swap(std::size_t left, std::size_t right) noexcept;
+
+    void siftUp(std::size_t position) noexcept;
+    void siftDown(std::size_t position) noexcept;
+
+    template<class F>
+    void forEachDue(std::size_t position, time_t deadline, F& f) const;
+
+    std::array<std::size_t, N> m_heap;      //!< Timers, the soonest first
+    std::array<std::size_t, N> m_positions; //!< Heap positions of the timers, NoPosition if inactive
+    std::array<time_t, N> m_deadlines;
+    std::size_t m_size;
+};
+
+template<class time_t, std::size_t N>
+inline TimerHeap<time_t, N>::TimerHeap() noexcept {
+    m_heap.fill(NoPosition);
+    m_deadlines.fill(time_t());
+    clear();
+}
+
+template<class time_t, std::size_t N>
+inline void TimerHeap<time_t, N>::schedule(std::size_t timer, time_t deadline) noexcept {
+    std::size_t position = m_positions[timer];
+
+    if (position == NoPosition) {
+        m_deadlines[timer] = deadline;
+        place(m_size, timer);
+        siftUp(m_size++);
+        return;
+    }
+
+    bool earlier = deadline < m_deadlines[timer];
+    m_deadlines[timer] = deadline;
+
+    if (earlier)
+        siftUp(position);
+    else
+        siftDown(position);
+}
+
+template<class time_t, std::size_t N>
+inline void TimerHeap<time_t, N>::cancel(std::size_t timer) noexcept {
+    std::size_t position = m_positions[timer];
+    if (position == NoPosition)
+        return;
+
+    m_positions[timer] = NoPosition;
+    if (position == --m_size)
+        return;
+
+    // the last one takes the place
+    place(position, m_heap[m_size]);
+
+    if (position && isEarlier(position, (position - 1) / 2))
+        siftUp(position);
+    else
+        siftDown(position);
+}
+
+template<class time_t, std::size_t N>
+template<class F>
+inline void TimerHeap<time_t, N>::forEachDue(time_t deadline, F&& f) const {
+    if (m_size)
+        forEachDue(0, deadline, f);
+}
+
+template<class time_t, std::size_t N>
+template<class F>
+inline void TimerHeap<time_t, N>::forEachDue(std::size_t position, time_t deadline, F& f) const {
+    if (deadline < m_deadlines[m_heap[position]])
+        return;
+
+    f(m_heap[position]);
+
+    std::size_t child = position * 2 + 1;
+    if (child < m_size)
+        forEachDue(child, deadline, f);
+    if (child + 1 < m_size)
+        forEachDue(child + 1, deadline, f);
+}
+
+template<class time_t, std::size_t N>
+inline void TimerHeap<time_t, N>::clear() noexcept {
+    m_positions.fill(NoPosition);
+    m_size = 0;
+}
+
+template<class time_t, std::size_t N>
+inline void TimerHeap<time_t, N>::swap(std::size_t left, std::size_t right) noexcept {
+    std::size_t leftTimer = m_heap[left];
+    place(left, m_heap[right]);
+    place(right, leftTimer);
+}
+
+template<class time_t, std::size_t N>
+inline void TimerHeap<time_t, N>::siftUp(std::size_t position) noexcept {
+    while (position) {
+        std::size_t parent = (position - 1) / 2;
+        if (!isEarlier(position, parent))
+            break;
+
+        swap(position, parent);
+        position = parent;
+    }
+}
+
+template<class time_t, std::size_t N>
+inline void TimerHeap<time_t, N>::siftDown(std::size_t position) noexcept {
+    for (;;) {
+        std::size_t child = position * 2 + 1;
+        if (child >= m_size)
+            break;
+
+        if (child + 1 < m_size && isEarlier(child + 1, child))
+            ++child;
+
+        if (!isEarlier(child, position))
+            break;
+
+        swap(position, child);
+        position = child;
+    }
+}
+
+}
+
+#endif // !TIMER_HEAP_HPP
@@ -0,0 +1,241 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#include "VectorEnvironment.hpp"
+#include "VisibleZone.hpp"
+#include "GameData.hpp"
+#include "AttribEnums.hpp"
+#include "LevelElements.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace {
+
+// splitmix64, the games of near numbers get unrelated seeds
+std::uint64_t getGameSeed(std::uint64_t seed, std::uint64_t gameNumber) noexcept {
+    std::uint64_t z = seed + (gameNumber + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// out[i] = convert(the cell x + i of the row y), the whole rows of a grid not paged are read straight
+template<class T, class F>
+void convertRow(const CrazySnakes::PagedGrid<T>& grid, int x, int y, std::size_t count,
+                std::uint8_t* out, F&& convert) noexcept {
+    if (!grid.isPaged()) {
+        const T* row = grid.getCells() + x + (std::size_t)y * grid.getSize().x;
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = convert(row[i]);
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = convert(grid.get(x + (int)i, y));
+}
+
+}
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void VectorEnvironment::reset(const LevelSetup& setup, const Options& options) {
+    m_setup = &setup;
+    m_options = options;
+
+    const Levels& levels = setup.getGameData()->getLevels();
+    const std::uint32_t* attribs = levels.getLevelAttribPtr(setup.getDifficulty(), setup.getLevelIndex());
+    const std::uint32_t* plot = levels.getLevelPlotDataPtr(setup.getDifficulty(), setup.getLevelIndex());
+
+    m_snakePeriod = (std::int64_t)attribs[(int)LevelAttribEnum::SnakePeriod];
+    m_itemScores[(std::size_t)EatableItem::Fruit] = plot[(int)LevelPlotDataEnum::FruitScoreCoeff];
+    m_itemScores[(std::size_t)EatableItem::Bonus] = plot[(int)LevelPlotDataEnum::BonusScoreCoeff];
+    m_itemScores[(std::size_t)EatableItem::Powerup] = plot[(int)LevelPlotDataEnum::SuperbonusScoreCoeff];
+
+    // the zone is a cell wider or higher while the camera follows the snake
+    m_sight = sf::Vector2i((int)plot[(int)LevelPlotDataEnum::SnakeSightX],
+                           (int)plot[(int)LevelPlotDataEnum::SnakeSightY]);
+    m_windowSize = sf::Vector2u(m_sight * 2 + sf::Vector2i(2, 2));
+
+    m_games.clear();
+    m_games.reserve(options.gameCount);
+
+    for (std::size_t i = 0; i < options.gameCount; ++i) {
+        auto instance = std::make_unique<Instance>();
+        instance->randomizers.setSeed(getGameSeed(options.seed, i));
+
+        std::array<Randomizer*, RandomTypeCount> randomizers = instance->randomizers.getPointers();
+        instance->game.restart(setup.createGameImpl(randomizers.data()));
+
+        // the steps need the subevents only
+        instance->game.setMainEventMask(0);
+
+        m_games.push_back(std::move(instance));
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void VectorEnvironment::restart(std::uint8_t* observations) {
+    std::size_t observationSize = getObservationSize();
+
+    for (std::size_t i = 0; i < m_games.size(); ++i) {
+        restart(*m_games[i]);
+        observe(*m_games[i], observations + i * observationSize);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void VectorEnvironment::step(const std::uint32_t* actions, std::uint8_t* observations,
+                             float* rewards, std::uint8_t* dones) {
+    std::size_t observationSize = getObservationSize();
+
+    for (std::size_t i = 0; i < m_games.size(); ++i) {
+        Instance& instance = *m_games[i];
+        rewards[i] = step(instance, actions[i]);
+
+        bool done = !instance.game.getImpl().isSnakeAlive() ||
+            (m_options.stepLimit && instance.stepCount >= m_options.stepLimit);
+
+        dones[i] = done;
+        if (done)
+            restart(instance);
+
+        observe(instance, observations + i * observationSize);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void VectorEnvironment::restart(Instance& instance) {
+    instance.game.restart(m_setup->getInitialObjectMemory());
+    instance.now = 0;
+    instance.stepCount = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+float VectorEnvironment::step(Instance& instance, std::uint32_t action) {
+    Game& game = instance.game;
+
+    // the command goes right after the previous step
+    if (action < NoAction)
+        game.pushCommand(instance.now, (Direction)action);
+    game.update(instance.now);
+
+    std::int64_t timeToMove = game.getEventProcessor().getTimeToEvent((std::size_t)MainGameEvent::Moved);
+    instance.now += (timeToMove > 0 ? timeToMove : m_snakePeriod);
+    game.update(instance.now);
+    ++instance.stepCount;
+
+    static_assert((int)GameSubevent::BonusEaten - (int)GameSubevent::FruitEaten == (int)EatableItem::Bonus &&
+                  (int)GameSubevent::PowerupEaten - (int)GameSubevent::FruitEaten == (int)EatableItem::Powerup);
+
+    std::uintmax_t score = 0;
+    std::size_t count;
+    do {
+        count = game.pollEvents(m_events.data(), m_events.size());
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const Game::Event& event = m_events[i];
+            if (event.isMain)
+                continue;
+
+            int item = (int)event.subevent - (int)GameSubevent::FruitEaten;
+            if (item >= 0 && item < ItemCount)
+                score += m_itemScores[(std::size_t)item];
+        }
+    } while (count == m_events.size());
+
+    return (float)score;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void VectorEnvironment::observe(const Instance& instance, std::uint8_t* observation) const noexcept {
+    const GameImpl& impl = instance.game.getImpl();
+    const SnakeWorld& world = impl.getSnakeWorld();
+    const sf::Vector2u& mapSize = world.getMapSize();
+    const sf::Vector2i& head = world.getCurrentSnakePosition();
+    const std::uint32_t* objectPairs = impl.getLevelPointers().objectPairIndices;
+
+    VisibleZone zone = getVisibleZone(mapSize, m_sight, head, world.getPreviousDirection());
+    assert(zone.size.x <= (int)m_windowSize.x && zone.size.y <= (int)m_windowSize.y);
+
+    std::size_t area = (std::size_t)m_windowSize.x * m_windowSize.y;
+    std::uint8_t* objects = observation + (std::size_t)Plane::Object * area;
+    std::uint8_t* memories = observation + (std::size_t)Plane::ObjectMemory * area;
+    std::uint8_t* items = observation + (std::size_t)Plane::Item * area;
+    std::uint8_t* snake = observation + (std::size_t)Plane::Snake * area;
+
+    std::memset(observation, 0, getObservationSize());
+
+    int left = std::max(zone.leftTop.x, 0);
+    int right = std::min(zone.leftTop.x + zone.size.x, (int)mapSize.x);
+    int bottom = std::min(zone.leftTop.y + zone.size.y, (int)mapSize.y);
+    std::size_t width = (std::size_t)std::max(right - left, 0);
+
+    for (int y = std::max(zone.leftTop.y, 0); y < bottom; ++y) {
+        std::size_t index = (std::size_t)(left - zone.leftTop.x) +
+            (std::size_t)(y - zone.leftTop.y) * m_windowSize.x;
+
+        const std::uint32_t* pairs = objectPairs + left + (std::size_t)y * mapSize.x;
+        for (std::size_t i = 0; i < width; ++i)
+            objects[index + i] = (std::uint8_t)(std::min<std::uint32_t>(pairs[i], UINT8_MAX - 1) + 1);
+
+        convertRow(impl.getObjectMemoryGrid(), left, y, width, memories + index, [](std::uint32_t memory) {
+            return (std::uint8_t)std::min<std::uint32_t>(memory, UINT8_MAX);
+        });
+
+        convertRow(world.getItemGrid(), left, y, width, items + index, [](std::uint8_t item) {
+            return (std::uint8_t)(item == (std::uint8_t)EatableItem::Count ? 0 : item + 1);
+        });
+    }
+
+    // the snake is mostly shorter than the zone is wide
+    auto getIndex = [&zone, right, bottom, this](const sf::Vector2i& position) {
+        if (position.x < zone.leftTop.x || position.x >= right ||
+            position.y < zone.leftTop.y || position.y >= bottom)
+            return (std::size_t)-1;
+
+        return (std::size_t)(position.x - zone.leftTop.x) +
+            (std::size_t)(position.y - zone.leftTop.y) * m_windowSize.x;
+    };
+
+    world.forEachTailSegment([&snake, &getIndex](const SnakeWorld::TailSegment& segment) {
+        std::size_t index = getIndex(segment.position);
+        if (index != (std::size_t)-1)
+            snake[index] = 1;
+    });
+
+    std::size_t headIndex = getIndex(head);
+    if (headIndex != (std::size_t)-1)
+        snake[headIndex] = 2;
+}
+
+} // namespace CrazySnakes
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#ifndef VECTOR_ENVIRONMENT_HPP
+#define VECTOR_ENVIRONMENT_HPP
+#include "Game.hpp"
+#include "Randomizer.hpp"
+#include <SFML/System/Vector2.hpp>
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+class LevelSetup;
+
+/// Many independent games of one level stepped together, for reinforcement learning.
+/// A step is one snake move: the action is the command pushed right before it
+/// (a Direction or NoAction), the reward is the score it brings.
+/// The observation is the visible zone around the head (see getVisibleZone), a byte per cell
+/// in every plane, written to the top left of a window of the greatest zone size;
+/// the cells beyond the zone or the map are 0 in all the planes.
+/// A finished game (the snake is dead or the step limit is reached) restarts at once,
+/// its observation is then the one of the new start.
+/// The games are seeded by the seed and their number, so they don't depend on the game count.
+class VectorEnvironment {
+public:
+
+    enum class Plane {
+        Object,       // ObjectPair + 1, 255 for the pair indices of 254 and more
+        ObjectMemory, // the object memory, 255 at most
+        Item,         // EatableItem + 1, 0 if none
+        Snake,        // 1 on the tail, 2 on the head
+        Count
+    };
+
+    static constexpr std::size_t PlaneCount = (std::size_t)Plane::Count;
+    static constexpr auto NoAction = (std::uint32_t)Direction::Count; // the snake goes on as it does
+
+    struct Options {
+        std::size_t gameCount = 1;
+        std::uint64_t seed = 0;
+        std::uintmax_t stepLimit = 0; // 0 means none
+    };
+
+    // setup: a dependency; the games are restarted, the observations are then there
+    void reset(const LevelSetup& setup, const Options& options);
+
+    std::size_t getGameCount() const noexcept {
+        return m_games.size();
+    }
+
+    // width and height of the window
+    const sf::Vector2u& getWindowSize() const noexcept {
+        return m_windowSize;
+    }
+
+    // bytes of one game: the planes one by one, row-major
+    std::size_t getObservationSize() const noexcept {
+        return PlaneCount * m_windowSize.x * m_windowSize.y;
+    }
+
+    // all the games from the start; observations: getObservationSize() per game
+    void restart(std::uint8_t* observations);
+
+    // actions, rewards and dones: one per game
+    void step(const std::uint32_t* actions, std::uint8_t* observations, float* rewards, std::uint8_t* dones);
+
+private:
+
+    struct Instance {
+        RandomizerSet randomizers;
+        Game game;
+        std::int64_t now = 0;
+        std::uintmax_t stepCount = 0;
+    };
+
+    void restart(Instance& instance);
+    float step(Instance& instance, std::uint32_t action);
+    void observe(const Instance& instance, std::uint8_t* observation) const noexcept;
+
+    const LevelSetup* m_setup = nullptr;
+    Options m_options;
+    std::vector<std::unique_ptr<Instance>> m_games; // the games refer to their randomizers
+    std::array<Game::Event, 64> m_events{};
+    std::array<std::uint32_t, ItemCount> m_itemScores{}; // by EatableItem
+    std::int64_t m_snakePeriod = 0;
+    sf::Vector2i m_sight;
+    sf::Vector2u m_windowSize;
+};
+
+} // namespace CrazySnakes
+
+#endif // !VECTOR_ENVIRONMENT_HPP
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////
+//
+// Snatan - Extreme Snake Game
+// Copyright (c) 2024 Oleh Kiprik (oleg.kiprik@proton.me)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+
+#include "VisibleZone.hpp"
+#include "ObjectParameterEnums.hpp"
+#include <cassert>
+#include <cstdint>
+
+namespace CrazySnakes {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool isCameraStopped(const sf::Vector2u& mapSize, const sf::Vector2i& sight,
+                     const sf::Vector2i& snakePosition, Direction previousDirection) noexcept {
+    // snake stands
+    if (previousDirection == Direction::Count)
+        return true;
+
+    // camera collided with border?
+    sf::Vector2i mapSizei(mapSize);
+
+    switch (previousDirection) {
+    case Direction::Up:
+        return (snakePosition.y < sight.y) ||
+            (snakePosition.y + 1 >= mapSizei.y - sight.y);
+    case Direction::Right:
+        return (snakePosition.x < sight.x + 1) ||
+            (snakePosition.x >= mapSizei.x - sight.x);
+    case Direction::Down:
+        return (snakePosition.y < sight.y + 1) ||
+            (snakePosition.y >= mapSizei.y - sight.y);
+    case Direction::Left:
+        return (snakePosition.x < sight.x) ||
+            (snakePosition.x + 1 >= mapSizei.x - sight.x);
+    default:
+        break;
+    }
+
+    assert(false);
+    return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+VisibleZone getVisibleZone(const sf::Vector2u& mapSize, const sf::Vector2i& sight,
+                           const sf::Vector2i& snakePosition, Direction previousDirection) noexcept {
+    sf::Vector2i mapSizei(mapSize);
+
+    // corners
+    sf::Vector2i leftTopInMap = snakePosition - sight;
+    sf::Vector2i rightDownInMap = snakePosition + sight;
+
+    if (!isCameraStopped(mapSize, sight, snakePosition, previousDirection)) {
+        switch (previousDirection) {
+        case Direction::Up:
+            ++rightDownInMap.y;
+            break;
+        case Direction::Down:
+            --leftTopInMap.y;
+            break;
+        case Direction::Left:
+            ++rightDownInMap.x;
+            break;
+        case Direction::Right:
+            --leftTopInMap.x;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // prevent camera overshift
+
+    // x
+    if (leftTopInMap.x < 0) {
+        rightDownInMap.x -= leftTopInMap.x;
+        leftTopInMap.x = 0;
+    } else if (rightDownInMap.x >= mapSizei.x) {
+        sf::Vector2i previousRightDown = rightDownInMap;
+        rightDownInMap.x = mapSizei.x - 1;
+        leftTopInMap += rightDownInMap - previousRightDown;
+    }
+
+    // y
+    if (leftTopInMap.y < 0) {
+        rightDownInMap.y -= leftTopInMap.y;
+        leftTopInMap.y = 0;
+    } else if (rightDownInMap.y >= mapSizei.y) {
+        sf::Vector2i previousRightDown = rightDownInMap;
+        rightDownInMap.y = mapSizei.y - 1;
+        leftTopInMap += rightDownInMap - previousRightDown;
+    }
+
+    return VisibleZone{ leftTopInMap, rightDownInMap + sf::Vector2i(1, 1) - leftTopInMap };
+}
+
+} // namespace CrazySnakes
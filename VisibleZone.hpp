@@ -23,28 +23,32 @@
 //
 ////////////////////////////////////////////////////////////
 
-#ifndef RANDOMIZER_IMPL_HPP
-#define RANDOMIZER_IMPL_HPP
-#include "Randomizer.hpp"
-#include <random>
 
-namespace CrazySnakes {
+#ifndef VISIBLE_ZONE_HPP
+#define VISIBLE_ZONE_HPP
+#include <SFML/System/Vector2.hpp>
 
-// independent
-class RandomizerImpl : public Randomizer {
-public:
+namespace CrazySnakes {
 
-	RandomizerImpl();
+enum class Direction;
 
-	void setSeed(std::uint64_t seed);
+// The map cells the camera shows around the snake head
+struct VisibleZone {
+    sf::Vector2i leftTop;
+    sf::Vector2i size;
+};
 
-	[[nodiscard]] virtual std::uint64_t get(std::uint64_t least, std::uint64_t greatest) override;
+// sight: the cells seen from the head each way (LevelPlotDataEnum::SnakeSightX and Y)
 
-private:
+// The camera doesn't follow the snake: the snake stands or the view rests on the map border
+bool isCameraStopped(const sf::Vector2u& mapSize, const sf::Vector2i& sight,
+                     const sf::Vector2i& snakePosition, Direction previousDirection) noexcept;
 
-	std::mt19937_64 m_gen;
-};
+// The sight around the head, one more cell behind it while the camera follows the snake,
+// shifted not to overshoot the map
+VisibleZone getVisibleZone(const sf::Vector2u& mapSize, const sf::Vector2i& sight,
+                           const sf::Vector2i& snakePosition, Direction previousDirection) noexcept;
 
 } // namespace CrazySnakes
 
-#endif // !RANDOMIZER_IMPL_HPP
+#endif // !VISIBLE_ZONE_HPP